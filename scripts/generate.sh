@@ -1,16 +1,25 @@
 
 #!/bin/bash
-cat generated/gen.txt src/Utils/Exception.h src/Utils/TokenScanner.h src/Utils/TokenScanner.cc src/Files/FileSystem.h src/List/UnrolledLinkedList.h src/List/UnrolledLinkedList.cc src/User/UserSystem.h src/User/UserSystem.cc src/Book/BookSystem.h src/Book/BookSystem.cc src/BookStore.h src/BookStore.cc src/main.cc >generated/submit.cc
+cat generated/gen.txt src/Utils/Exception.h src/Utils/Money.h src/Utils/TokenScanner.h src/Utils/TokenScanner.cc src/Files/FileSystem.h src/List/UnrolledLinkedList.h src/List/UnrolledLinkedList.cc src/List/PostingList.h src/Files/BkTree.h src/Files/Dictionary.h src/Files/ParallelScan.h src/User/UserSystem.h src/User/UserSystem.cc src/Book/QueryCache.h src/Book/QueryCache.cc src/Book/FinanceLog.h src/Book/FinanceLog.cc src/Book/BookSystem.h src/Book/BookSystem.cc src/BookStore.h src/BookStore.cc src/main.cc >generated/submit.cc
 sed -i '/#include "Exception.h"/'d ./generated/submit.cc
 sed -i '/#include "Utils\/Exception.h"/'d ./generated/submit.cc
+sed -i '/#include "Utils\/Money.h"/'d ./generated/submit.cc
 sed -i '/#include "TokenScanner.h"/'d ./generated/submit.cc
 sed -i '/#include "Utils\/TokenScanner.h"/'d ./generated/submit.cc
 sed -i '/#include "FileSystem.h"/'d ./generated/submit.cc
 sed -i '/#include "Files\/FileSystem.h"/'d ./generated/submit.cc
 sed -i '/#include "UnrolledLinkedList.h"/'d ./generated/submit.cc
 sed -i '/#include "List\/UnrolledLinkedList.h"/'d ./generated/submit.cc
+sed -i '/#include "List\/PostingList.h"/'d ./generated/submit.cc
+sed -i '/#include "Files\/Dictionary.h"/'d ./generated/submit.cc
+sed -i '/#include "Files\/BkTree.h"/'d ./generated/submit.cc
+sed -i '/#include "Files\/ParallelScan.h"/'d ./generated/submit.cc
 sed -i '/#include "UserSystem.h"/'d ./generated/submit.cc
 sed -i '/#include "User\/UserSystem.h"/'d ./generated/submit.cc
+sed -i '/#include "FinanceLog.h"/'d ./generated/submit.cc
+sed -i '/#include "Book\/FinanceLog.h"/'d ./generated/submit.cc
+sed -i '/#include "QueryCache.h"/'d ./generated/submit.cc
+sed -i '/#include "Book\/QueryCache.h"/'d ./generated/submit.cc
 sed -i '/#include "BookSystem.h"/'d ./generated/submit.cc
 sed -i '/#include "Book\/BookSystem.h"/'d ./generated/submit.cc
 sed -i '/#include "Bookstore.h"/'d ./generated/submit.cc
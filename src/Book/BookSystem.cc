@@ -1,12 +1,17 @@
 #include "BookSystem.h"
 
 #include <algorithm>
+#include <climits>
+#include <cmath>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <utility>
 
+#include "List/PostingList.h"
 #include "Utils/Exception.h"
 #include "Utils/TokenScanner.h"
 
@@ -15,60 +20,60 @@ namespace bookstore {
 namespace book {
 
 BookInfo::BookInfo()
-    : isbn(), name(), author(), keyword_cnt(0), quantity(0), price(0.0) {}
-
-BookInfo::BookInfo(const char *_isbn, const char *_name, const char *_author,
-                   const std::vector<BookStr> &_keyword, const double _price)
-    : isbn(_isbn), name(_name), author(_author), price(_price) {
-    keyword_cnt = _keyword.size();
-    for (int i = 0; i < _keyword.size(); i++)
-        keyword[i] = _keyword[i];
-}
-
-void BookInfo::PrintInfo() const {
-    std::cout << isbn.str << '\t' << name.str << '\t' << author.str << '\t';
-    for (int i = 0; i < keyword_cnt; i++) {
-        if (i)
-            std::cout << '|';
-        std::cout << keyword[i].str;
-    }
-    std::cout << '\t' << price << '\t' << quantity << '\n';
-}
+    : isbn(), name(0), author(0), keyword(), keyword_cnt(0), quantity(0),
+      sales(0), pos(0), price() {}
 
 BookFileSystem::BookFileSystem()
-    : BaseFileSystem("book"), isbn_table("isbn"), name_table("name"),
-      author_table("author"), key_table("key"), siz(0) {}
+    : BaseFileSystem("book"), siz(0), isbn_table("isbn"), name_table("name"),
+      author_table("author"), key_table("key"), price_table("price"),
+      quantity_table("quantity"), sales_table("sales"),
+      name_dict("name", true, true), author_dict("author", true),
+      key_dict("key"), line_table("book_line") {}
 
+// Insert a book, or get the position of the existing one by a single probe
 std::pair<int, bool> BookFileSystem::insert(const IsbnStr &isbn,
                                             const BookInfo &data) {
-    try {
-        isbn_table.insert(isbn, siz + 1);
-        siz++;
-        name_table.insert(data.name, siz);
-        author_table.insert(data.author, siz);
-        for (int i = 0; i < data.keyword_cnt; i++)
-            key_table.insert(data.keyword[i], siz);
-        BaseFileSystem::insert(siz, data);
-        return std::make_pair(siz, true);
-    } catch (const NormalException &x) {
-        if (x.what() == ULL_INSERTED)
-            return std::make_pair(isbn_table.find(isbn), false);
-        else {
-            x.error();
-            exit(-1);
-        }
-    }
+    std::pair<int, bool> ret = isbn_table.upsert(isbn, siz + 1);
+    if (!ret.second)
+        return ret;
+    siz++;
+    Invalidate(BookCondition::ISBN, isbn);
+    BookIndex index(isbn, siz);
+    if (data.name)
+        name_table.insert(data.name, index);
+    if (data.author)
+        author_table.insert(data.author, index);
+    for (int i = 0; i < data.keyword_cnt; i++)
+        key_table.insert(data.keyword[i], index);
+    price_table.insert(data.price, index);
+    quantity_table.insert(data.quantity, index);
+    BaseFileSystem::insert(siz, data);
+    Render(siz, data);
+    InvalidateResults(siz, data);
+    return ret;
 }
 
 std::pair<int, bool> BookFileSystem::erase(const IsbnStr &isbn) {
     try {
         int pos = isbn_table.erase(isbn);
         BookInfo tmp = BaseFileSystem::find(pos);
-        name_table.erase(tmp.name, pos);
-        author_table.erase(tmp.author, pos);
+        BookIndex index(tmp.isbn, pos);
+        Invalidate(BookCondition::ISBN, isbn);
+        Invalidate(BookCondition::NAME, name_dict.lookup(tmp.name));
+        Invalidate(BookCondition::AUTHOR, author_dict.lookup(tmp.author));
+        if (tmp.name)
+            name_table.erase(tmp.name, index);
+        if (tmp.author)
+            author_table.erase(tmp.author, index);
         for (int i = 0; i < tmp.keyword_cnt; i++)
-            key_table.erase(tmp.keyword[i], siz);
+            key_table.erase(tmp.keyword[i], index);
+        price_table.erase(tmp.price, index);
+        quantity_table.erase(tmp.quantity, index);
+        if (tmp.sales)
+            sales_table.erase(-tmp.sales, index);
+        InvalidateResults(pos, tmp);
         BaseFileSystem::erase(pos);
+        line_table.erase(pos);
         return std::make_pair(pos, true);
     } catch (const NormalException &x) {
         if (x.what() == ULL_ERASE_NOT_FOUND)
@@ -80,73 +85,143 @@ std::pair<int, bool> BookFileSystem::erase(const IsbnStr &isbn) {
     }
 }
 
-std::pair<int, bool> BookFileSystem::edit(const int pos, BookInfo data) {
+std::pair<int, bool> BookFileSystem::edit(const int pos, const IsbnStr &isbn,
+                                          const BookStr &name,
+                                          const BookStr &author,
+                                          const std::vector<BookStr> &keyword,
+                                          const Money &price) {
     BookInfo tmp = BaseFileSystem::find(pos);
-    if (!data.isbn.empty()) {
+    BookIndex old_index(tmp.isbn, pos);
+    if (!isbn.empty()) {
         try {
-            isbn_table.find(data.isbn);
+            isbn_table.find(isbn);
             return std::make_pair(pos, false);
         } catch (const NormalException &x) {
             if (x.what() == ULL_NOT_FOUND) {
                 isbn_table.erase(tmp.isbn);
-                isbn_table.insert(data.isbn, pos);
-                tmp.isbn = data.isbn;
+                isbn_table.insert(isbn, pos);
+                Invalidate(BookCondition::ISBN, tmp.isbn);
+                Invalidate(BookCondition::ISBN, isbn);
+                tmp.isbn = isbn;
             } else {
                 x.error();
                 exit(-1);
             }
         }
     }
-    if (!data.name.empty()) {
-        name_table.erase(tmp.name, pos);
-        name_table.insert(data.name, pos);
-        tmp.name = data.name;
+    // The index entries carry the ISBN, so they are all refreshed when the
+    // ISBN changes. Otherwise only the changed entries are touched.
+    BookIndex new_index(tmp.isbn, pos);
+    bool isbn_changed = old_index != new_index;
+    int new_name = name.empty() ? tmp.name : name_dict.intern(name);
+    if (new_name != tmp.name) {
+        Invalidate(BookCondition::NAME, name_dict.lookup(tmp.name));
+        Invalidate(BookCondition::NAME, name);
     }
-    if (!data.author.empty()) {
-        author_table.erase(tmp.author, pos);
-        author_table.insert(data.author, pos);
-        tmp.author = data.author;
+    if (new_name != tmp.name || isbn_changed) {
+        if (tmp.name)
+            name_table.erase(tmp.name, old_index);
+        tmp.name = new_name;
+        if (tmp.name)
+            name_table.insert(tmp.name, new_index);
+    }
+    int new_author = author.empty() ? tmp.author : author_dict.intern(author);
+    if (new_author != tmp.author) {
+        Invalidate(BookCondition::AUTHOR, author_dict.lookup(tmp.author));
+        Invalidate(BookCondition::AUTHOR, author);
+    }
+    if (new_author != tmp.author || isbn_changed) {
+        if (tmp.author)
+            author_table.erase(tmp.author, old_index);
+        tmp.author = new_author;
+        if (tmp.author)
+            author_table.insert(tmp.author, new_index);
+    }
+    if (!keyword.empty() || isbn_changed) {
+        std::vector<int> old_keys(tmp.keyword, tmp.keyword + tmp.keyword_cnt);
+        if (!keyword.empty()) {
+            std::vector<int> ids = key_dict.intern(keyword);
+            tmp.keyword_cnt = ids.size();
+            std::copy(ids.begin(), ids.end(), tmp.keyword);
+        }
+        std::vector<int> new_keys(tmp.keyword, tmp.keyword + tmp.keyword_cnt);
+        std::sort(old_keys.begin(), old_keys.end());
+        std::sort(new_keys.begin(), new_keys.end());
+        std::vector<list::DataType<int, BookIndex>> erased, inserted;
+        for (int key : old_keys)
+            if (isbn_changed ||
+                !std::binary_search(new_keys.begin(), new_keys.end(), key))
+                erased.push_back(list::DataType<int, BookIndex>(key, old_index));
+        for (int key : new_keys)
+            if (isbn_changed ||
+                !std::binary_search(old_keys.begin(), old_keys.end(), key))
+                inserted.push_back(
+                    list::DataType<int, BookIndex>(key, new_index));
+        key_table.bulk_erase(erased);
+        key_table.bulk_insert(inserted);
+    }
+    // A negative price keeps the old one
+    if (price.value() >= 0 || isbn_changed) {
+        price_table.erase(tmp.price, old_index);
+        if (price.value() >= 0)
+            tmp.price = price;
+        price_table.insert(tmp.price, new_index);
+    }
+    if (isbn_changed) {
+        quantity_table.erase(tmp.quantity, old_index);
+        quantity_table.insert(tmp.quantity, new_index);
+        if (tmp.sales) {
+            sales_table.erase(-tmp.sales, old_index);
+            sales_table.insert(-tmp.sales, new_index);
+        }
     }
-    if (data.keyword_cnt) {
-        for (int i = 0; i < tmp.keyword_cnt; i++)
-            key_table.erase(tmp.keyword[i], pos);
-        for (int i = 0; i < data.keyword_cnt; i++)
-            key_table.insert(data.keyword[i], pos);
-        memcpy(tmp.keyword, data.keyword, sizeof(data.keyword));
-        tmp.keyword_cnt = data.keyword_cnt;
-    }
-    if (data.price != -1)
-        tmp.price = data.price;
     BaseFileSystem::erase(pos);
     BaseFileSystem::insert(pos, tmp);
+    Render(pos, tmp);
+    InvalidateResults(pos, tmp);
     return std::make_pair(pos, true);
 }
 
-std::pair<double, bool>
-BookFileSystem::import(const int pos, const int quantity, const double cost) {
+std::pair<Money, bool>
+BookFileSystem::import(const int pos, const int quantity, const Money &cost) {
     if (!pos)
         throw InvalidException("Import a book before select it");
     BookInfo tmp = BaseFileSystem::find(pos);
+    BookIndex index(tmp.isbn, pos);
+    quantity_table.erase(tmp.quantity, index);
     tmp.quantity += quantity;
+    quantity_table.insert(tmp.quantity, index);
     BaseFileSystem::erase(pos);
     BaseFileSystem::insert(pos, tmp);
+    Render(pos, tmp);
+    query_cache.InvalidateBook(pos);
     return std::make_pair(cost, true);
 }
 
-std::pair<double, bool> BookFileSystem::buy(const IsbnStr &isbn,
-                                            const int quantity) {
+std::pair<Money, bool> BookFileSystem::buy(const IsbnStr &isbn,
+                                           const int quantity) {
     try {
         int pos = isbn_table.find(isbn);
         BookInfo tmp = BaseFileSystem::find(pos);
         if (tmp.quantity < quantity)
-            return std::make_pair(0.0, false);
+            return std::make_pair(Money(), false);
+        Money total = tmp.price * quantity;
+        BookIndex index(tmp.isbn, pos);
+        quantity_table.erase(tmp.quantity, index);
         tmp.quantity -= quantity;
+        quantity_table.insert(tmp.quantity, index);
+        if (tmp.sales)
+            sales_table.erase(-tmp.sales, index);
+        tmp.sales += quantity;
+        sales_table.insert(-tmp.sales, index);
         BaseFileSystem::erase(pos);
         BaseFileSystem::insert(pos, tmp);
-        return std::make_pair(tmp.price, true);
+        Render(pos, tmp);
+        query_cache.InvalidateBook(pos);
+        return std::make_pair(total, true);
     } catch (const NormalException &x) {
         if (x.what() == ULL_NOT_FOUND)
-            return std::make_pair(0.0, false);
+            return std::make_pair(Money(), false);
         else {
             x.error();
             exit(-1);
@@ -154,6 +229,217 @@ std::pair<double, bool> BookFileSystem::buy(const IsbnStr &isbn,
     }
 }
 
+/**
+ * @brief Buy a cart of books atomically
+ * @details The ISBNs are resolved by a single sorted pass over the index, and
+ * the stock of every item is checked before anything is changed. The records
+ * are then rewritten in the order of position, and the quantity and sales
+ * indices are updated by bulk operations. The quantities of a repeated ISBN
+ * are added up.
+ * @param items (pairs of ISBN and quantity)
+ * @return std::pair<Money, bool> (the total price, and whether bought)
+ */
+std::pair<Money, bool>
+BookFileSystem::buy(std::vector<std::pair<IsbnStr, int>> items) {
+    std::sort(items.begin(), items.end());
+    std::vector<IsbnStr> isbns;
+    std::vector<long long> quantities;
+    for (int i = 0; i < items.size(); i++) {
+        if (i && items[i].first == items[i - 1].first) {
+            quantities.back() += items[i].second;
+            continue;
+        }
+        isbns.push_back(items[i].first);
+        quantities.push_back(items[i].second);
+    }
+    std::vector<int> positions = isbn_table.bulk_find(isbns);
+    std::vector<int> order(positions.size());
+    for (int i = 0; i < order.size(); i++) {
+        if (!positions[i])
+            return std::make_pair(Money(), false);
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&positions](int x, int y) { return positions[x] < positions[y]; });
+    std::vector<BookInfo> books;
+    Money total;
+    for (int i : order) {
+        books.push_back(BaseFileSystem::find(positions[i]));
+        if (books.back().quantity < quantities[i])
+            return std::make_pair(Money(), false);
+        Money price = books.back().price * quantities[i];
+        if (total > Money(LLONG_MAX) - price)
+            throw InvalidException("Money overflow");
+        total += price;
+    }
+    std::vector<list::DataType<int, BookIndex>> quantity_erased,
+        quantity_inserted, sales_erased, sales_inserted;
+    for (int k = 0; k < order.size(); k++) {
+        BookInfo &book = books[k];
+        int pos = positions[order[k]], quantity = quantities[order[k]];
+        BookIndex index(book.isbn, pos);
+        quantity_erased.push_back(
+            list::DataType<int, BookIndex>(book.quantity, index));
+        book.quantity -= quantity;
+        quantity_inserted.push_back(
+            list::DataType<int, BookIndex>(book.quantity, index));
+        if (book.sales)
+            sales_erased.push_back(
+                list::DataType<int, BookIndex>(-book.sales, index));
+        book.sales += quantity;
+        sales_inserted.push_back(
+            list::DataType<int, BookIndex>(-book.sales, index));
+        BaseFileSystem::erase(pos);
+        BaseFileSystem::insert(pos, book);
+        Render(pos, book);
+        query_cache.InvalidateBook(pos);
+    }
+    quantity_table.bulk_erase(quantity_erased);
+    quantity_table.bulk_insert(quantity_inserted);
+    sales_table.bulk_erase(sales_erased);
+    sales_table.bulk_insert(sales_inserted);
+    return std::make_pair(total, true);
+}
+
+/**
+ * @brief Set the prices of a batch of books
+ * @details The records are read and then written in the order of position, so
+ * the batch is a sequential pass over the file, and nothing is written if a
+ * new price overflows. The books not satisfying the filter are skipped, and
+ * the price index is updated by a bulk erasure and a bulk insertion at the
+ * end.
+ * @param index (the candidates)
+ * @param filter
+ * @param price (the new price, or nullptr to scale the old one)
+ * @param scale
+ * @return int (the number of books repriced)
+ */
+int BookFileSystem::reprice(const std::vector<BookIndex> &index,
+                            const std::vector<BookCondition> &filter,
+                            const Money *price, const double scale) {
+    std::vector<int> positions;
+    for (const auto &cur : index)
+        positions.push_back(cur.value);
+    std::sort(positions.begin(), positions.end());
+    std::vector<BookInfo> books;
+    std::vector<Money> new_prices;
+    int cnt = 0;
+    for (int pos : positions) {
+        BookInfo book = BaseFileSystem::find(pos);
+        book.pos = pos;
+        bool matched = true;
+        for (const auto &cond : filter)
+            matched = matched && Match(book, cond);
+        if (!matched)
+            continue;
+        cnt++;
+        Money new_price = price ? *price : book.price.scale(scale);
+        if (new_price == book.price)
+            continue;
+        books.push_back(book);
+        new_prices.push_back(new_price);
+    }
+    std::vector<list::DataType<Money, BookIndex>> erased, inserted;
+    for (int i = 0; i < books.size(); i++) {
+        BookInfo &book = books[i];
+        int pos = book.pos;
+        BookIndex cur(book.isbn, pos);
+        erased.push_back(list::DataType<Money, BookIndex>(book.price, cur));
+        inserted.push_back(
+            list::DataType<Money, BookIndex>(new_prices[i], cur));
+        book.price = new_prices[i];
+        BaseFileSystem::erase(pos);
+        BaseFileSystem::insert(pos, book);
+        Render(pos, book);
+        query_cache.InvalidateBook(pos);
+    }
+    price_table.bulk_erase(erased);
+    price_table.bulk_insert(inserted);
+    return cnt;
+}
+
+/**
+ * @brief Insert a batch of new books
+ * @details The books are sorted by ISBN and appended to the records in that
+ * order. The strings are interned together, and the entries of each index are
+ * added by a bulk insertion. Nothing is changed if any ISBN exists already or
+ * appears twice in the batch. The rows are validated by the caller, with at
+ * most kMaxKeywordCnt keywords each.
+ * @param rows
+ * @return true if the books are inserted
+ */
+bool BookFileSystem::BulkInsert(std::vector<BookRow> &rows) {
+    std::sort(rows.begin(), rows.end(),
+              [](const BookRow &x, const BookRow &y) { return x.isbn < y.isbn; });
+    std::vector<IsbnStr> isbns;
+    std::vector<BookStr> names, authors, keywords;
+    for (int i = 0; i < rows.size(); i++) {
+        if (i && rows[i].isbn == rows[i - 1].isbn)
+            return false;
+        isbns.push_back(rows[i].isbn);
+        names.push_back(rows[i].name);
+        authors.push_back(rows[i].author);
+        keywords.insert(keywords.end(), rows[i].keyword.begin(),
+                        rows[i].keyword.end());
+    }
+    for (int pos : isbn_table.bulk_find(isbns))
+        if (pos)
+            return false;
+    std::vector<int> name_ids = name_dict.intern(names);
+    std::vector<int> author_ids = author_dict.intern(authors);
+    std::vector<int> key_ids = key_dict.intern(keywords);
+
+    std::vector<list::DataType<IsbnStr>> isbn_data;
+    std::vector<list::DataType<int, BookIndex>> name_data, author_data,
+        key_data, quantity_data;
+    std::vector<list::DataType<Money, BookIndex>> price_data;
+    std::ostringstream out;
+    for (int i = 0, k = 0; i < rows.size(); i++) {
+        const BookRow &row = rows[i];
+        int pos = siz + i + 1;
+        BookIndex index(row.isbn, pos);
+        BookInfo book(row.isbn.str);
+        book.name = name_ids[i];
+        book.author = author_ids[i];
+        book.keyword_cnt = row.keyword.size();
+        for (int j = 0; j < book.keyword_cnt; j++)
+            book.keyword[j] = key_ids[k++];
+        book.price = row.price;
+        book.quantity = row.quantity;
+        BaseFileSystem::insert(pos, book);
+
+        out.str("");
+        FormatInfo(row.isbn, row.name, row.author, row.keyword, book.price,
+                   book.quantity, out);
+        StoreLine(pos, out.str());
+
+        isbn_data.push_back(list::DataType<IsbnStr>(row.isbn, pos));
+        if (book.name)
+            name_data.push_back(list::DataType<int, BookIndex>(book.name, index));
+        if (book.author)
+            author_data.push_back(
+                list::DataType<int, BookIndex>(book.author, index));
+        for (int j = 0; j < book.keyword_cnt; j++)
+            key_data.push_back(
+                list::DataType<int, BookIndex>(book.keyword[j], index));
+        price_data.push_back(
+            list::DataType<Money, BookIndex>(book.price, index));
+        quantity_data.push_back(
+            list::DataType<int, BookIndex>(book.quantity, index));
+    }
+    isbn_table.bulk_insert(isbn_data);
+    name_table.bulk_insert(name_data);
+    author_table.bulk_insert(author_data);
+    key_table.bulk_insert(key_data);
+    price_table.bulk_insert(price_data);
+    quantity_table.bulk_insert(quantity_data);
+    siz += rows.size();
+    query_cache.clear();
+    for (auto &cache : complete_cache)
+        cache.clear();
+    return true;
+}
+
 BookInfo BookFileSystem::FileSearchByISBN(const IsbnStr &isbn) {
     try {
         int pos = isbn_table.find(isbn);
@@ -170,141 +456,852 @@ BookInfo BookFileSystem::FileSearchByISBN(const IsbnStr &isbn) {
     }
 }
 
-std::vector<BookInfo> BookFileSystem::FileSearchByName(const BookStr &name) {
-    std::vector<int> pos = name_table.find(name);
-    std::vector<BookInfo> ret;
-    ret.clear();
-    for (auto p : pos)
-        ret.push_back(BaseFileSystem::find(p));
-    std::sort(ret.begin(), ret.end());
+/**
+ * @brief Call take on the entries of a table from the given one
+ * @details The table is scanned in batches of batch_len until take returns
+ * false or the table ends, so only the blocks needed are read.
+ * @param table
+ * @param from
+ * @param batch_len
+ * @param take
+ */
+template <class Key, class Value, class Take>
+void ScanFrom(list::UnrolledLinkedList<Key, Value> &table,
+              list::DataType<Key, Value> from, const size_t batch_len,
+              Take take) {
+    bool resumed = false; // from was taken at the end of the last batch
+    while (true) {
+        auto batch = table.scan(from, batch_len);
+        for (int i = resumed; i < batch.size(); i++)
+            if (!take(batch[i]))
+                return;
+        if (batch.size() < batch_len)
+            return;
+        from = batch.back(), resumed = true;
+    }
+}
+
+/**
+ * @brief Get the books with the given id from a secondary index
+ * @details A page is read by scanning the index from its cursor, so its cost
+ * does not depend on the number of books before it.
+ * @param table
+ * @param id
+ * @param page
+ * @return std::vector<BookIndex> (in the order of ISBN)
+ */
+std::vector<BookIndex> BookFileSystem::FileSearchByIndex(multimap &table,
+                                                         const int id,
+                                                         const BookPage &page) {
+    if (!id) // the string has never been used by any book
+        return std::vector<BookIndex>();
+    if (!page.paged())
+        return table.find(id); // already in the order of ISBN
+    std::vector<BookIndex> ret;
+    if (!page.limit)
+        return ret;
+    // the entries of the cursor are all less than this one
+    BookIndex after(page.after, page.after.empty() ? 0 : INT_MAX);
+    int skip = page.offset;
+    ScanFrom(table, list::DataType<int, BookIndex>(id, after), kFetchBatch,
+             [&](const list::DataType<int, BookIndex> &data) {
+                 if (data.key != id)
+                     return false;
+                 if (skip)
+                     return skip--, true;
+                 ret.push_back(data.value);
+                 return page.limit == -1 || ret.size() < page.limit;
+             });
     return ret;
 }
 
-std::vector<BookInfo>
-BookFileSystem::FileSearchByAuthor(const BookStr &author) {
-    std::vector<int> pos = author_table.find(author);
-    std::vector<BookInfo> ret;
-    ret.clear();
-    for (auto p : pos)
-        ret.push_back(BaseFileSystem::find(p));
-    std::sort(ret.begin(), ret.end());
+std::vector<BookIndex> BookFileSystem::FileSearchByName(const BookStr &name,
+                                                        const BookPage &page) {
+    return FileSearchByIndex(name_table, name_dict.find(name), page);
+}
+
+std::vector<BookIndex>
+BookFileSystem::FileSearchByAuthor(const BookStr &author,
+                                   const BookPage &page) {
+    return FileSearchByIndex(author_table, author_dict.find(author), page);
+}
+
+std::vector<BookIndex>
+BookFileSystem::FileSearchByKeyword(const BookStr &keyword,
+                                    const BookPage &page) {
+    return FileSearchByIndex(key_table, key_dict.find(keyword), page);
+}
+
+// Get a page of all the books by scanning the isbn index from the cursor
+std::vector<BookIndex> BookFileSystem::FileSearchAll(const BookPage &page) {
+    std::vector<BookIndex> ret;
+    if (!page.limit)
+        return ret;
+    int skip = page.offset;
+    ScanFrom(isbn_table, list::DataType<IsbnStr>(page.after, INT_MAX),
+             kFetchBatch, [&](const list::DataType<IsbnStr> &data) {
+                 if (skip)
+                     return skip--, true;
+                 ret.push_back(BookIndex(data.key, data.value));
+                 return page.limit == -1 || ret.size() < page.limit;
+             });
+    return ret;
+}
+
+// Keep the part of a whole result in the page
+void BookPage::apply(std::vector<BookIndex> &index) const {
+    auto beg = index.begin();
+    if (!after.empty())
+        beg = std::upper_bound(index.begin(), index.end(), after,
+                               [](const IsbnStr &isbn, const BookIndex &x) {
+                                   return isbn < x.order;
+                               });
+    beg += std::min<size_t>(offset, index.end() - beg);
+    index.erase(index.begin(), beg);
+    if (limit != -1 && index.size() > limit)
+        index.resize(limit);
+}
+
+std::string BookPage::Encode(const IsbnStr &isbn) {
+    static const char kHex[] = "0123456789abcdef";
+    std::string ret;
+    for (const char *ch = isbn.str; *ch; ch++) {
+        ret += kHex[(unsigned char)*ch >> 4];
+        ret += kHex[*ch & 15];
+    }
+    return ret;
+}
+
+IsbnStr BookPage::Decode(const std::string &cursor) {
+    std::string str;
+    for (int i = 0; i + 1 < cursor.size(); i += 2)
+        str += char(std::stoi(cursor.substr(i, 2), nullptr, 16));
+    return IsbnStr(str.c_str());
+}
+
+/**
+ * @brief Get the books whose key is in [low, high] from a numeric index
+ * @details The index is scanned from low in batches of batch_len, and stops at
+ * the first key greater than high.
+ * @param table
+ * @param low
+ * @param high
+ * @param batch_len
+ * @return std::vector<BookIndex> (in the order of key, then ISBN)
+ */
+template <class Key>
+std::vector<BookIndex> ScanRange(list::UnrolledLinkedList<Key, BookIndex> &table,
+                                 const Key &low, const Key &high,
+                                 const size_t batch_len) {
+    std::vector<BookIndex> ret;
+    list::DataType<Key, BookIndex> from(low, BookIndex());
+    while (true) {
+        auto batch = table.scan(from, batch_len);
+        for (const auto &data : batch) {
+            if (data.key > high)
+                return ret;
+            ret.push_back(data.value);
+        }
+        if (batch.size() < batch_len)
+            return ret;
+        // the position is unique, so this is right after the last one
+        const auto &las = batch.back();
+        from = list::DataType<Key, BookIndex>(
+            las.key, BookIndex(las.value.order, las.value.value + 1));
+    }
+}
+
+std::vector<BookIndex> BookFileSystem::FileSearchByPrice(const Money &low,
+                                                         const Money &high) {
+    return ScanRange(price_table, low, high, kFetchBatch);
+}
+
+std::vector<BookIndex> BookFileSystem::FileSearchByStock(const int threshold) {
+    if (threshold <= 0)
+        return std::vector<BookIndex>();
+    return ScanRange(quantity_table, 0, threshold - 1, kFetchBatch);
+}
+
+/**
+ * @brief Get the best selling books
+ * @details Only the sold books are in the sales index, ordered by the negative
+ * sales, so the first entries are the bestsellers.
+ * @param count
+ * @return std::vector<BookIndex> (in the descending order of sales)
+ */
+std::vector<BookIndex> BookFileSystem::FileSearchBestsellers(const int count) {
+    std::vector<BookIndex> ret;
+    for (const auto &data : sales_table.scan(
+             list::DataType<int, BookIndex>(INT_MIN, BookIndex()), count))
+        ret.push_back(data.value);
+    return ret;
+}
+
+/**
+ * @brief Get the books satisfying a prepared condition
+ * @details Fetch the sorted list of every id and unite them.
+ * @param cond
+ * @return std::vector<BookIndex> (in the order of ISBN)
+ */
+std::vector<BookIndex>
+BookFileSystem::FileSearchByCondition(const BookCondition &cond) {
+    std::vector<BookIndex> ret;
+    for (int i = 0; i < cond.ids.size(); i++) {
+        std::vector<BookIndex> tmp;
+        if (cond.field == BookCondition::ISBN) {
+            if (cond.ids[i])
+                tmp.push_back(
+                    BookIndex(IsbnStr(cond.values[i].c_str()), cond.ids[i]));
+        } else
+            tmp = FileSearchByIndex(TableOf(cond.field), cond.ids[i]);
+        ret = ret.empty() ? tmp : list::Unite(ret, tmp);
+    }
+    return ret;
+}
+
+/**
+ * @brief Prepare a condition for searching
+ * @details Look up the ids of the values, and estimate the number of books
+ * satisfying the condition by the statistics of the index. A part of name or
+ * author is looked up in the trigram index of the dictionary, and turns into
+ * the ids of all the strings containing it. A misspelled name turns into the
+ * ids of the nearest names found in the BK-tree.
+ * @param cond
+ * @return size_t (the estimated number of books, 0 if surely none)
+ */
+size_t BookFileSystem::Prepare(BookCondition &cond) {
+    cond.ids.clear();
+    cond.estimate = 0;
+    for (const auto &value : cond.values) {
+        if (cond.field == BookCondition::ISBN) {
+            BookInfo book = FileSearchByISBN(IsbnStr(value.c_str()));
+            cond.ids.push_back(book.empty() ? 0 : book.pos);
+            cond.estimate += !book.empty();
+            continue;
+        }
+        if (cond.field == BookCondition::NAME_PART ||
+            cond.field == BookCondition::AUTHOR_PART) {
+            dict &cur_dict = cond.field == BookCondition::NAME_PART
+                                 ? name_dict
+                                 : author_dict;
+            std::vector<int> ids = cur_dict.FindSubstring(value);
+            cond.ids.insert(cond.ids.end(), ids.begin(), ids.end());
+        } else if (cond.field == BookCondition::NAME_FUZZY) {
+            std::vector<int> ids = name_dict.FindSimilar(
+                value, kFuzzyDistance, kFuzzyCount,
+                [this](int id) { return InUse(name_table, id); });
+            cond.ids.insert(cond.ids.end(), ids.begin(), ids.end());
+        } else {
+            dict &cur_dict = cond.field == BookCondition::NAME ? name_dict
+                             : cond.field == BookCondition::AUTHOR
+                                 ? author_dict
+                                 : key_dict;
+            cond.ids.push_back(cur_dict.find(BookStr(value.c_str())));
+        }
+    }
+    if (cond.field != BookCondition::ISBN)
+        for (int id : cond.ids)
+            if (id)
+                cond.estimate += TableOf(cond.field).estimate(id);
+    return cond.estimate;
+}
+
+/**
+ * @brief Judge whether a book satisfies a prepared condition
+ * @param book
+ * @param cond
+ */
+bool BookFileSystem::Match(const BookInfo &book,
+                           const BookCondition &cond) const {
+    for (int id : cond.ids) {
+        if (!id)
+            continue;
+        if (cond.field == BookCondition::ISBN) {
+            if (book.pos == id)
+                return true;
+        } else if (cond.field == BookCondition::NAME ||
+                   cond.field == BookCondition::NAME_PART ||
+                   cond.field == BookCondition::NAME_FUZZY) {
+            if (book.name == id)
+                return true;
+        } else if (cond.field == BookCondition::AUTHOR ||
+                   cond.field == BookCondition::AUTHOR_PART) {
+            if (book.author == id)
+                return true;
+        } else {
+            for (int j = 0; j < book.keyword_cnt; j++)
+                if (book.keyword[j] == id)
+                    return true;
+        }
+    }
+    return false;
+}
+
+multimap &BookFileSystem::TableOf(const BookCondition::Field field) {
+    if (field == BookCondition::NAME || field == BookCondition::NAME_PART ||
+        field == BookCondition::NAME_FUZZY)
+        return name_table;
+    if (field == BookCondition::AUTHOR || field == BookCondition::AUTHOR_PART)
+        return author_table;
+    return key_table;
+}
+
+/**
+ * @brief Judge whether an id is still used by some book
+ * @details A string stays in the dictionary after the last book using it is
+ * modified, so the index is checked by reading at most one block.
+ * @param table
+ * @param id
+ */
+bool BookFileSystem::InUse(multimap &table, const int id) {
+    auto ret = table.scan(list::DataType<int, BookIndex>(id, BookIndex()), 1);
+    return !ret.empty() && ret[0].key == id;
+}
+
+/**
+ * @brief Get the strings starting with prefix from a sorted table
+ * @details The table is scanned from the prefix in batches until a string
+ * without the prefix is met or limit strings satisfying keep are found.
+ * @param table (either the isbn table or the string -> id map of a dictionary)
+ * @param prefix
+ * @param limit
+ * @param keep (judge whether to return the string by its value)
+ * @return std::vector<std::string> (in ascending order)
+ */
+template <class Key, class Table, class Keep>
+std::vector<std::string> ScanPrefix(Table &table, const std::string &prefix,
+                                    const size_t limit, Keep keep) {
+    std::vector<std::string> ret;
+    list::DataType<Key> from(Key(prefix.c_str()), 0);
+    size_t batch_len = std::max(limit, size_t(16));
+    while (ret.size() < limit) {
+        auto batch = table.scan(from, batch_len);
+        for (const auto &data : batch) {
+            if (strncmp(data.key.str, prefix.c_str(), prefix.size()))
+                return ret;
+            if (keep(data.value))
+                ret.push_back(data.key.str);
+            if (ret.size() == limit)
+                return ret;
+        }
+        if (batch.size() < batch_len)
+            break;
+        from = list::DataType<Key>(batch.back().key, batch.back().value + 1);
+    }
     return ret;
 }
 
-std::vector<BookInfo>
-BookFileSystem::FileSearchByKeyword(const BookStr &keyword) {
-    std::vector<int> pos = key_table.find(keyword);
-    std::vector<BookInfo> ret;
-    ret.clear();
-    for (auto p : pos)
-        ret.push_back(BaseFileSystem::find(p));
-    std::sort(ret.begin(), ret.end());
+/**
+ * @brief Get the first ISBNs, names or authors starting with prefix
+ * @details The results are cached for each prefix. A cached result answers a
+ * smaller limit as well, or any limit when it has fewer items than its own.
+ * Only the names and authors of existing books are returned.
+ * @param field (ISBN, NAME or AUTHOR)
+ * @param prefix
+ * @param limit
+ * @return std::vector<std::string> (in ascending order)
+ */
+std::vector<std::string>
+BookFileSystem::Complete(const BookCondition::Field field,
+                         const std::string &prefix, const size_t limit) {
+    auto &cache = complete_cache[field];
+    auto it = cache.find(prefix);
+    if (it != cache.end() && (it->second.limit >= limit ||
+                              it->second.items.size() < it->second.limit)) {
+        auto &items = it->second.items;
+        return std::vector<std::string>(
+            items.begin(), items.begin() + std::min(limit, items.size()));
+    }
+    std::vector<std::string> ret;
+    if (field == BookCondition::ISBN)
+        ret = ScanPrefix<IsbnStr>(isbn_table, prefix, limit,
+                                  [](int) { return true; });
+    else if (field == BookCondition::NAME)
+        ret = ScanPrefix<BookStr>(name_dict, prefix, limit, [this](int id) {
+            return InUse(name_table, id);
+        });
+    else
+        ret = ScanPrefix<BookStr>(author_dict, prefix, limit, [this](int id) {
+            return InUse(author_table, id);
+        });
+    if (cache.size() >= kMaxCompleteCache)
+        cache.clear();
+    cache[prefix] = CompleteResult{limit, ret};
     return ret;
 }
 
+/**
+ * @brief Drop the cached completions affected by a changed string
+ * @details The completions of every prefix of str are dropped.
+ * @param field
+ * @param str
+ */
+void BookFileSystem::Invalidate(const BookCondition::Field field,
+                                const std::string &str) {
+    auto &cache = complete_cache[field];
+    if (cache.empty() || str.empty())
+        return;
+    for (size_t len = 1; len <= str.size(); len++)
+        cache.erase(str.substr(0, len));
+}
+
+/**
+ * @brief Drop the cached query results affected by a changed book
+ * @details The results containing the book are dropped, and so are those with
+ * a term matching the new fields of the book, which it may newly satisfy.
+ * @param pos
+ * @param book (the new record)
+ */
+void BookFileSystem::InvalidateResults(const int pos, const BookInfo &book) {
+    query_cache.InvalidateBook(pos);
+    query_cache.InvalidateTerm(Term(BookCondition::ISBN, book.isbn));
+    if (book.name)
+        query_cache.InvalidateTerm(
+            Term(BookCondition::NAME, name_dict.lookup(book.name)));
+    if (book.author)
+        query_cache.InvalidateTerm(
+            Term(BookCondition::AUTHOR, author_dict.lookup(book.author)));
+    for (int i = 0; i < book.keyword_cnt; i++)
+        query_cache.InvalidateTerm(
+            Term(BookCondition::KEYWORD, key_dict.lookup(book.keyword[i])));
+}
+
+std::string BookFileSystem::Term(const BookCondition::Field field,
+                                 const std::string &value) {
+    return std::to_string(field) + '=' + value;
+}
+
+// Print the cached result of query, return false if not cached
+bool BookFileSystem::PrintCached(const std::string &query) {
+    const std::string *result = query_cache.find(query);
+    if (!result)
+        return false;
+    std::cout << *result;
+    return true;
+}
+
+/**
+ * @brief Print the books of a result and cache the output
+ * @details An empty result is printed as an empty line, and cached as well.
+ * @param query
+ * @param terms
+ * @param index
+ * @param filter
+ */
+void BookFileSystem::PrintAndCache(const std::string &query,
+                                   const std::vector<std::string> &terms,
+                                   const std::vector<BookIndex> &index,
+                                   const std::vector<BookCondition> &filter) {
+    std::ostringstream out;
+    std::vector<int> printed;
+    if (!PrintByIndex(index, filter, out, &printed))
+        out << '\n';
+    std::cout << out.str();
+    query_cache.insert(query, out.str(), printed, terms);
+}
+
+// Render the output line of the book at pos into the sidecar file
+void BookFileSystem::Render(const int pos, const BookInfo &book) {
+    std::ostringstream out;
+    PrintInfo(book, out);
+    StoreLine(pos, out.str());
+}
+
+// Store a rendered line into the sidecar file
+void BookFileSystem::StoreLine(const int pos, const std::string &str) {
+    BookLine line;
+    if (str.size() >= sizeof(line.str))
+        throw UnknownException(UNKNOWN, "Book line is too long");
+    line.len = str.size();
+    memcpy(line.str, str.c_str(), line.len);
+    line_table.insert(pos, line);
+}
+
+/**
+ * @brief Render the lines of all the books
+ * @details Used when the sidecar file is missing or shorter than the records,
+ * e.g. for the data created before the lines were kept.
+ */
+void BookFileSystem::RenderAll() {
+    line_table.flush();
+    size_t cnt = std::filesystem::file_size("data/book_line.dat") /
+                 sizeof(BookLine);
+    if (cnt >= siz)
+        return;
+    for (int pos = 1; pos <= siz; pos++) {
+        BookInfo book = BaseFileSystem::find(pos);
+        if (!book.empty())
+            Render(pos, book);
+    }
+}
+
+void BookFileSystem::PrintLine(const int pos, std::ostream &out) {
+    BookLine line = line_table.find(pos);
+    out.write(line.str, line.len);
+}
+
+void BookFileSystem::PrintInfo(const BookInfo &book, std::ostream &out) {
+    std::vector<BookStr> keyword;
+    for (int i = 0; i < book.keyword_cnt; i++)
+        keyword.push_back(key_dict.lookup(book.keyword[i]));
+    FormatInfo(book.isbn, name_dict.lookup(book.name),
+               author_dict.lookup(book.author), keyword, book.price,
+               book.quantity, out);
+}
+
+// Write the output line of a book from its strings
+void BookFileSystem::FormatInfo(const IsbnStr &isbn, const BookStr &name,
+                                const BookStr &author,
+                                const std::vector<BookStr> &keyword,
+                                const Money &price, const int quantity,
+                                std::ostream &out) {
+    out << isbn.str << '\t' << name.str << '\t' << author.str << '\t';
+    for (int i = 0; i < keyword.size(); i++) {
+        if (i)
+            out << '|';
+        out << keyword[i].str;
+    }
+    out << '\t' << price << '\t' << quantity << '\n';
+}
+
+/**
+ * @brief Print the books of a result in the order of ISBN
+ * @details The result is handled in batches of kFetchBatch. The rendered lines
+ * of a batch are fetched in the order of position for sequential reading, then
+ * written in the order of the index. With a filter, the records are read as
+ * well, and only the books satisfying all its conditions are written.
+ * @param index
+ * @param filter
+ * @param out
+ * @param printed (if not null, the positions of the printed books are added)
+ * @return int (the number of books printed)
+ */
+int BookFileSystem::PrintByIndex(const std::vector<BookIndex> &index,
+                                 const std::vector<BookCondition> &filter,
+                                 std::ostream &out, std::vector<int> *printed) {
+    std::vector<std::pair<int, int>> order; // (position, rank in the batch)
+    std::vector<BookLine> batch;
+    int cnt = 0;
+    for (int beg = 0; beg < index.size(); beg += kFetchBatch) {
+        int len = std::min(int(index.size()) - beg, int(kFetchBatch));
+        order.clear();
+        for (int i = 0; i < len; i++)
+            order.push_back(std::make_pair(index[beg + i].value, i));
+        std::sort(order.begin(), order.end());
+        batch.assign(len, BookLine());
+        for (const auto &p : order) {
+            if (!filter.empty()) { // the record is only read for the filter
+                BookInfo book = BaseFileSystem::find(p.first);
+                book.pos = p.first;
+                bool flag = true;
+                for (const auto &cond : filter)
+                    flag = flag && Match(book, cond);
+                if (!flag)
+                    continue;
+            }
+            batch[p.second] = line_table.find(p.first);
+        }
+        for (int i = 0; i < len; i++) {
+            if (batch[i].empty()) // filtered out
+                continue;
+            out.write(batch[i].str, batch[i].len), cnt++;
+            if (printed)
+                printed->push_back(index[beg + i].value);
+        }
+    }
+    return cnt;
+}
+
+/**
+ * @brief Print all the books in the order of ISBN
+ * @details Walk the isbn index by kFetchBatch entries at a time, so the memory
+ * used does not grow with the catalog and the first batch is printed at once.
+ * A large catalog is read by a parallel scan of the rendered lines instead,
+ * which reads sequentially rather than one line per index entry, and falls
+ * back to the walk if the lines cannot be read.
+ * @return int (the number of books printed)
+ */
+int BookFileSystem::PrintAll() {
+    int cnt = 0;
+    if (siz >= kParallelScanMin) {
+        line_table.flush();
+        if (file::ParallelScanner<BookLine>("book_line")
+                .scan([&](const BookLine &line) {
+                    std::cout.write(line.str, line.len);
+                    cnt++;
+                }))
+            return cnt;
+    }
+    list::DataType<IsbnStr> from; // less than any ISBN
+    std::vector<BookIndex> index;
+    while (true) {
+        auto batch = isbn_table.scan(from, kFetchBatch);
+        if (batch.empty())
+            break;
+        index.clear();
+        for (const auto &data : batch)
+            index.push_back(BookIndex(data.key, data.value));
+        PrintByIndex(index);
+        cnt += batch.size();
+        // the ISBN is unique, so this is right after the last one
+        from = list::DataType<IsbnStr>(batch.back().key,
+                                       batch.back().value + 1);
+    }
+    return cnt;
+}
+
 void BookFileSystem::output() {
     std::cout << "Book status:\n";
     for (int i = 1; i <= siz; i++) {
         BookInfo tmp = BaseFileSystem::find(i);
-        tmp.PrintInfo();
+        PrintInfo(tmp);
     }
     std::cout << '\n';
 }
 
-BookSystem::BookSystem() : book_table() {
+BookSystem::BookSystem() : book_table(), finance_log("finance") {
     std::ifstream fin("./data/book.log");
     if (fin.good()) {
         int len;
-        fin >> book_table.siz >> len;
-        total_earn.resize(len);
-        total_cost.resize(len);
-        for (int i = 0; i < len; i++)
-            fin >> total_earn[i] >> total_cost[i];
-    } else {
-        total_earn.push_back(0);
-        total_cost.push_back(0);
+        fin >> book_table.siz;
+        // The ledger used to be kept as text after the size, move it over
+        // with the times unknown, as if they were at the epoch
+        if (fin >> len && len > 1 && !finance_log.size()) {
+            double earn, cost;
+            Money las_earn, las_cost;
+            fin >> earn >> cost;
+            for (int i = 1; i < len; i++) {
+                fin >> earn >> cost;
+                Money cur_earn(std::llround(earn * 100)),
+                    cur_cost(std::llround(cost * 100));
+                finance_log.push(cur_earn - las_earn, cur_cost - las_cost, 0);
+                las_earn = cur_earn, las_cost = cur_cost;
+            }
+        }
+        book_table.RenderAll();
     }
 }
 BookSystem::~BookSystem() {
     std::ofstream fout("./data/book.log", std::ios::out | std::ios::trunc);
-    int len = total_earn.size();
-    fout << book_table.siz << ' ' << len << '\n';
-    for (int i = 0; i < len; i++)
-        fout << total_earn[i] << ' ' << total_cost[i] << '\n';
+    fout << book_table.siz << '\n';
 }
 
 int BookSystem::SelectBook(const char *isbn) {
-    BookInfo tmp = book_table.FileSearchByISBN(IsbnStr(isbn));
-    if (tmp.empty()) {
-        tmp.isbn = isbn;
-        return book_table.insert(IsbnStr(isbn), tmp).first;
-    } else
-        return tmp.pos;
+    return book_table.insert(IsbnStr(isbn), BookInfo(isbn)).first;
 }
 void BookSystem::ModifyBook(const int book_pos, const char *_isbn,
                             const char *_name, const char *_author,
                             const std::vector<BookStr> &_key,
-                            const double _price) {
+                            const Money &_price) {
     if (!book_pos)
         throw InvalidException("Modify a book before selecting it");
     if (!book_table
-             .edit(book_pos, BookInfo(_isbn, _name, _author, _key, _price))
+             .edit(book_pos, IsbnStr(_isbn), BookStr(_name), BookStr(_author),
+                   _key, _price)
              .second)
         throw InvalidException("ISBN exists.");
 }
 
-void BookSystem::SearchByISBN(const char *isbn) {
+void BookSystem::SearchByISBN(const char *isbn, const BookPage &page) {
     BookInfo tmp = book_table.FileSearchByISBN(IsbnStr(isbn));
+    if (page.paged()) {
+        std::vector<BookIndex> index;
+        if (!tmp.empty())
+            index.push_back(BookIndex(tmp.isbn, tmp.pos));
+        page.apply(index);
+        return PrintPage(index, page);
+    }
     if (tmp.empty()) {
         std::cout << '\n';
         return;
     }
-    tmp.PrintInfo();
+    book_table.PrintLine(tmp.pos);
+}
+
+void BookSystem::SearchByName(const char *name, const BookPage &page) {
+    if (page.paged())
+        return PrintPage(book_table.FileSearchByName(BookStr(name), page),
+                         page);
+    std::string query = BookFileSystem::Term(BookCondition::NAME, name);
+    if (book_table.PrintCached(query))
+        return;
+    book_table.PrintAndCache(query, {query},
+                             book_table.FileSearchByName(BookStr(name)));
 }
 
-void BookSystem::SearchByName(const char *name) {
-    std::vector<BookInfo> tmp = book_table.FileSearchByName(BookStr(name));
+void BookSystem::SearchByAuthor(const char *author, const BookPage &page) {
+    if (page.paged())
+        return PrintPage(book_table.FileSearchByAuthor(BookStr(author), page),
+                         page);
+    std::string query = BookFileSystem::Term(BookCondition::AUTHOR, author);
+    if (book_table.PrintCached(query))
+        return;
+    book_table.PrintAndCache(query, {query},
+                             book_table.FileSearchByAuthor(BookStr(author)));
+}
+
+void BookSystem::SearchByKeyword(const char *keyword, const BookPage &page) {
+    if (page.paged())
+        return PrintPage(
+            book_table.FileSearchByKeyword(BookStr(keyword), page), page);
+    std::string query = BookFileSystem::Term(BookCondition::KEYWORD, keyword);
+    if (book_table.PrintCached(query))
+        return;
+    book_table.PrintAndCache(query, {query},
+                             book_table.FileSearchByKeyword(BookStr(keyword)));
+}
+
+/**
+ * @brief Search the books satisfying all the conditions
+ * @details Plan by the estimated number of books of each condition. The
+ * smallest list is fetched first, then a following condition is intersected
+ * with its list, or checked against the fetched records when its list is much
+ * longer than the candidates.
+ * @param conds
+ */
+void BookSystem::SearchByConditions(std::vector<BookCondition> conds,
+                                    const BookPage &page) {
+    // Only the results of exact conditions are cached, the books which may
+    // newly satisfy them are known by the terms
+    bool cacheable = !page.paged();
+    std::vector<std::string> query_conds, terms;
+    for (const auto &cond : conds) {
+        if (cond.field > BookCondition::KEYWORD) {
+            cacheable = false;
+            break;
+        }
+        std::string values;
+        for (const auto &value : cond.values) {
+            values += (values.empty() ? "" : "|") + value;
+            terms.push_back(BookFileSystem::Term(cond.field, value));
+        }
+        query_conds.push_back(BookFileSystem::Term(cond.field, values));
+    }
+    std::string query;
+    std::sort(query_conds.begin(), query_conds.end());
+    for (const auto &str : query_conds)
+        query += str + ' ';
+    if (cacheable && book_table.PrintCached(query))
+        return;
+
+    std::vector<BookCondition> filter;
+    // A page is cut from the whole result, so nothing is left to filter
+    std::vector<BookIndex> ret = Resolve(conds, filter, !page.paged());
+    if (page.paged()) {
+        page.apply(ret);
+        PrintPage(ret, page);
+    } else if (cacheable)
+        book_table.PrintAndCache(query, terms, ret, filter);
+    else if (ret.empty() || !book_table.PrintByIndex(ret, filter))
+        std::cout << '\n';
+}
+
+/**
+ * @brief Get the books satisfying all the conditions
+ * @details The conditions are evaluated from the most selective one. When the
+ * result is already small enough, the remaining conditions may be moved to the
+ * filter, to be checked on the records instead of reading their indices.
+ * @param conds
+ * @param filter (the conditions left to check on the records)
+ * @param with_filter (whether conditions may be moved to the filter)
+ * @return std::vector<BookIndex> (the candidates in the order of ISBN)
+ */
+std::vector<BookIndex> BookSystem::Resolve(std::vector<BookCondition> &conds,
+                                           std::vector<BookCondition> &filter,
+                                           const bool with_filter) {
+    std::vector<BookIndex> ret;
+    for (auto &cond : conds)
+        if (!book_table.Prepare(cond))
+            return ret;
+    std::sort(conds.begin(), conds.end(),
+              [](const BookCondition &x, const BookCondition &y) {
+                  return x.estimate < y.estimate;
+              });
+    ret = book_table.FileSearchByCondition(conds[0]);
+    for (int i = 1; i < conds.size() && !ret.empty(); i++) {
+        if (with_filter && ret.size() * kFetchCost < conds[i].estimate)
+            filter.push_back(conds[i]);
+        else
+            ret = list::Intersect(ret,
+                                  book_table.FileSearchByCondition(conds[i]));
+    }
+    return ret;
+}
+
+/**
+ * @brief Reprice all the books satisfying the conditions
+ * @param conds
+ * @param price (the new price, or nullptr to scale the old one)
+ * @param scale
+ * @return int (the number of books repriced)
+ */
+int BookSystem::Reprice(std::vector<BookCondition> conds, const Money *price,
+                        const double scale) {
+    std::vector<BookCondition> filter;
+    std::vector<BookIndex> ret = Resolve(conds, filter, true);
+    return book_table.reprice(ret, filter, price, scale);
+}
+
+void BookSystem::SearchByPrice(const Money &low, const Money &high) {
+    std::vector<BookIndex> tmp = book_table.FileSearchByPrice(low, high);
     if (tmp.empty()) {
         std::cout << '\n';
         return;
     }
-    for (const auto &tmp_book : tmp)
-        tmp_book.PrintInfo();
-    return;
+    book_table.PrintByIndex(tmp);
 }
 
-void BookSystem::SearchByAuthor(const char *author) {
-    std::vector<BookInfo> tmp = book_table.FileSearchByAuthor(BookStr(author));
+void BookSystem::SearchLowStock(const int threshold) {
+    std::vector<BookIndex> tmp = book_table.FileSearchByStock(threshold);
     if (tmp.empty()) {
         std::cout << '\n';
         return;
     }
-    for (const auto &tmp_book : tmp)
-        tmp_book.PrintInfo();
-    return;
+    book_table.PrintByIndex(tmp);
 }
 
-void BookSystem::SearchByKeyword(const char *keyword) {
-    std::vector<BookInfo> tmp =
-        book_table.FileSearchByKeyword(BookStr(keyword));
+void BookSystem::SearchBestsellers(const int count) {
+    std::vector<BookIndex> tmp = book_table.FileSearchBestsellers(count);
     if (tmp.empty()) {
         std::cout << '\n';
         return;
     }
-    for (const auto &tmp_book : tmp)
-        tmp_book.PrintInfo();
-    return;
+    book_table.PrintByIndex(tmp);
 }
 
-void BookSystem::SearchAll() {
-    std::set<BookInfo> tmp = book_table.search();
-    if (tmp.empty()) {
+void BookSystem::CompleteBook(const BookCondition::Field field,
+                              const char *prefix, const int limit) {
+    std::vector<std::string> ret = book_table.Complete(field, prefix, limit);
+    if (ret.empty())
+        std::cout << '\n';
+    for (const auto &str : ret)
+        std::cout << str << '\n';
+}
+
+void BookSystem::SearchAll(const BookPage &page) {
+    if (page.paged())
+        PrintPage(book_table.FileSearchAll(page), page);
+    else if (!book_table.PrintAll())
+        std::cout << '\n';
+}
+
+/**
+ * @brief Print a page of a result
+ * @details When the page is full, the cursor of the next page is printed in
+ * a line after the books.
+ * @param index
+ * @param page
+ */
+void BookSystem::PrintPage(const std::vector<BookIndex> &index,
+                           const BookPage &page) {
+    if (index.empty()) {
         std::cout << '\n';
         return;
     }
-    for (const BookInfo &tmp_book : tmp)
-        tmp_book.PrintInfo();
-    return;
+    book_table.PrintByIndex(index);
+    if (index.size() == page.limit)
+        std::cout << "-cursor=" << BookPage::Encode(index.back().order)
+                  << '\n';
 }
 
 void BookSystem::output() { book_table.output(); }
@@ -319,35 +1316,123 @@ void BookSystem::BuyBook(const char *isbn, const int quantity) {
     auto res = book_table.buy(IsbnStr(isbn), quantity);
     if (!res.second)
         throw InvalidException("Not found the book or no enough book!");
-    res.first *= quantity;
     std::cout << res.first << '\n';
-    total_earn.push_back(total_earn.back() + res.first);
-    total_cost.push_back(total_cost.back());
+    finance_log.push(res.first, Money());
+}
+
+void BookSystem::BuyCart(const std::vector<std::pair<IsbnStr, int>> &items) {
+    auto res = book_table.buy(items);
+    if (!res.second)
+        throw InvalidException("Not found the book or no enough book!");
+    std::cout << res.first << '\n';
+    finance_log.push(res.first, Money());
 }
 
 void BookSystem::ImportBook(const int book_pos, const int quantity,
-                            const double cost) {
+                            const Money &cost) {
 
     if (!book_table.import(book_pos, quantity, cost).second)
         throw InvalidException("Not found the book to import");
-    total_earn.push_back(total_earn.back());
-    total_cost.push_back(total_cost.back() + cost);
+    finance_log.push(Money(), cost);
+}
+
+/**
+ * @brief Load a catalog of new books from a TSV file
+ * @details Each line holds the ISBN, name, author, keywords separated by '|',
+ * price, quantity and total cost of a book, where the fields but ISBN may be
+ * empty and the cost may be omitted. The whole file is validated before any
+ * book is inserted, and the costs are recorded as a single finance entry if
+ * they are not zero.
+ * @param file_name
+ * @return int (the number of books loaded)
+ */
+int BookSystem::BulkLoad(const char *file_name) {
+    std::ifstream fin(file_name);
+    if (!fin.good())
+        throw InvalidException("Cannot open the file to load");
+    auto visible = [](const std::string &str) {
+        for (const char &ch : str)
+            if (!isgraph(ch) || ch == '\"')
+                return false;
+        return true;
+    };
+    std::vector<BookRow> rows;
+    Money cost;
+    std::string line;
+    while (std::getline(fin, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+        std::vector<std::string> field(1);
+        for (const char &ch : line) {
+            if (ch == '\t')
+                field.push_back("");
+            else
+                field.back() += ch;
+        }
+        if (field.size() == 6)
+            field.push_back("");
+        if (field.size() != 7 || field[0].empty() ||
+            !input::ValidateBookISBN(field[0]))
+            throw InvalidException("Invalid line in the file to load");
+        for (int i = 0; i < 4; i++)
+            if (!visible(field[i]) || !input::ValidateBookInfo(field[i]))
+                throw InvalidException("Invalid line in the file to load");
+        if ((!field[4].empty() && !input::ValidateDouble(field[4])) ||
+            (!field[5].empty() && (!input::ValidateInt(field[5]) ||
+                                   std::stoll(field[5]) > INT_MAX)) ||
+            (!field[6].empty() && !input::ValidateDouble(field[6])))
+            throw InvalidException("Invalid line in the file to load");
+        BookRow row;
+        row.isbn = field[0].c_str();
+        row.name = field[1].c_str();
+        row.author = field[2].c_str();
+        if (!field[3].empty()) {
+            if (field[3].back() == '|')
+                throw InvalidException("Invalid keyword");
+            std::vector<std::string> key_div;
+            for (std::string str : input::BookstoreLexer(field[3], '|')) {
+                if (!str.size())
+                    throw InvalidException("Check length");
+                key_div.push_back(str);
+                row.keyword.push_back(BookStr(str.c_str()));
+            }
+            if (key_div.size() > kMaxKeywordCnt)
+                throw InvalidException("Too many keywords");
+            std::sort(key_div.begin(), key_div.end());
+            for (int i = 1; i < key_div.size(); i++)
+                if (key_div[i] == key_div[i - 1])
+                    throw InvalidException("Duplicated keyword");
+        }
+        row.price = Money::Parse(field[4].empty() ? "0" : field[4]);
+        row.quantity = field[5].empty() ? 0 : std::stoi(field[5]);
+        cost += Money::Parse(field[6].empty() ? "0" : field[6]);
+        rows.push_back(row);
+    }
+    if (!book_table.BulkInsert(rows))
+        throw InvalidException("Load a book that already exists");
+    if (!rows.empty() && cost != Money())
+        finance_log.push(Money(), cost);
+    return rows.size();
 }
 
 void BookSystem::ShowFinance(const int rev) {
-    if (rev == -1)
-        std::cout << "+ " << total_earn.back() << " - " << total_cost.back()
-                  << '\n';
-    else if (rev == 0)
+    if (rev == 0) {
         std::cout << '\n';
-    else {
-        int cnt = total_earn.size() - 1;
-        if (cnt - rev < 0)
-            throw InvalidException("Show finance out of range");
-        double earn_dif = total_earn[cnt] - total_earn[cnt - rev];
-        double cost_dif = total_cost[cnt] - total_cost[cnt - rev];
-        std::cout << "+ " << earn_dif << " - " << cost_dif << '\n';
+        return;
     }
+    int cnt = rev == -1 ? finance_log.size() : rev;
+    if (cnt > finance_log.size())
+        throw InvalidException("Show finance out of range");
+    auto res = finance_log.sum(cnt);
+    std::cout << "+ " << res.first << " - " << res.second << '\n';
+}
+
+// Show the total earning and cost in the period [since, until)
+void BookSystem::ShowFinance(const long long since, const long long until) {
+    auto res = finance_log.sum(since, until);
+    std::cout << "+ " << res.first << " - " << res.second << '\n';
 }
 
 } // namespace book
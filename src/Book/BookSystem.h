@@ -1,12 +1,20 @@
 #ifndef BOOKSTORE_BOOKSYSTEM_H
 #define BOOKSTORE_BOOKSYSTEM_H
 
+#include <cstring>
+#include <iostream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "Book/FinanceLog.h"
+#include "Book/QueryCache.h"
+#include "Files/Dictionary.h"
 #include "Files/FileSystem.h"
+#include "Files/ParallelScan.h"
 #include "List/UnrolledLinkedList.h"
+#include "Utils/Money.h"
 
 namespace bookstore {
 
@@ -14,31 +22,123 @@ namespace book {
 
 const int kMaxISBNLen = 25;
 const int kMaxBookLen = 65;
+const int kMaxLineLen = 256;
+const int kMaxKeywordCnt = 15;
 
 using IsbnStr = list::KeyType<kMaxISBNLen>;
 using BookStr = list::KeyType<kMaxBookLen>;
 
-using map = list::UnrolledLinkedListUnique<kMaxISBNLen>;
-using multimap = list::UnrolledLinkedList<kMaxBookLen>;
+// The position of a book, ordered by its ISBN
+using BookIndex = list::OrderedValue<IsbnStr>;
+
+using map = list::UnrolledLinkedListUnique<IsbnStr>;
+using multimap = list::UnrolledLinkedList<int, BookIndex>;
+using pricemap = list::UnrolledLinkedList<Money, BookIndex>;
+using dict = file::Dictionary<kMaxBookLen>;
 
 class BookInfo {
   public:
     BookInfo();
     explicit BookInfo(const char *_isbn) : BookInfo() { isbn = _isbn; }
-    explicit BookInfo(const char *_isbn, const char *_name, const char *_author, const std::vector<BookStr> &_keyword, const double _price);
 
-    void PrintInfo() const;
     bool operator<(const BookInfo &x) const { return isbn < x.isbn; }
     bool empty() { return isbn == ""; }
 
   public:
-    list::KeyType<kMaxISBNLen> isbn;
-    list::KeyType<kMaxBookLen> name, author;
-    list::KeyType<kMaxBookLen> keyword[15];
+    IsbnStr isbn;
+    int name, author; // ids in the name and author dictionaries
+    int keyword[kMaxKeywordCnt]; // ids in the keyword dictionary
     int keyword_cnt;
     int quantity;
+    int sales; // the number of copies sold
     int pos;
-    double price;
+    Money price;
+};
+
+// A book read by a bulk load, with its strings not interned yet
+class BookRow {
+  public:
+    IsbnStr isbn;
+    BookStr name, author;
+    std::vector<BookStr> keyword;
+    Money price;
+    int quantity = 0;
+};
+
+/**
+ * @brief Class BookLine
+ * @details The rendered output line of a book, kept in a sidecar file and
+ * regenerated whenever the record changes. A line starts with the ISBN and a
+ * tab, so comparing lines gives the order of ISBN.
+ */
+class BookLine {
+  public:
+    BookLine() : len(0) { memset(str, 0, sizeof(str)); }
+
+    bool operator<(const BookLine &x) const { return strcmp(str, x.str) < 0; }
+    bool empty() const { return !len; }
+
+  public:
+    int len;
+    char str[kMaxLineLen];
+};
+
+// The longest line has the ISBN, name, author and keywords (validated within
+// one buffer each), a price of 21 and a quantity of 11 characters, 5 tabs, a
+// newline and the terminating zero
+static_assert((kMaxISBNLen - 1) + 3 * (kMaxBookLen - 1) + 21 + 11 + 6 + 1 <=
+                  kMaxLineLen,
+              "a rendered book line may not fit in a BookLine");
+
+/**
+ * @brief Class BookCondition
+ * @details A condition of a combined search, which is satisfied when the field
+ * of the book equals one of the values, contains one of them for NAME_PART
+ * and AUTHOR_PART, or is among the names nearest to one of them for
+ * NAME_FUZZY. The ids of the values and the
+ * estimated number of books are filled by BookFileSystem::Prepare.
+ */
+class BookCondition {
+  public:
+    enum Field {
+        ISBN,
+        NAME,
+        AUTHOR,
+        KEYWORD,
+        NAME_PART,
+        AUTHOR_PART,
+        NAME_FUZZY
+    };
+
+    BookCondition(const Field _field) : field(_field), estimate(0) {}
+
+  public:
+    Field field;
+    std::vector<std::string> values;
+    std::vector<int> ids; // positions for ISBN, dictionary ids for others
+    size_t estimate;
+};
+
+/**
+ * @brief Class BookPage
+ * @details A page of a result in the order of ISBN, which holds at most limit
+ * books after the cursor, skipping the first offset of them. The cursor is
+ * given to the client as the hex of the last ISBN of a page.
+ */
+class BookPage {
+  public:
+    BookPage() : after(), offset(0), limit(-1) {}
+
+    bool paged() const { return offset || limit != -1 || !after.empty(); }
+    void apply(std::vector<BookIndex> &index) const;
+
+    static std::string Encode(const IsbnStr &isbn);
+    static IsbnStr Decode(const std::string &cursor);
+
+  public:
+    IsbnStr after; // empty for the first page
+    int offset;
+    int limit; // -1 for no limit
 };
 
 class BookFileSystem : public file::BaseFileSystem<BookInfo> {
@@ -48,25 +148,111 @@ class BookFileSystem : public file::BaseFileSystem<BookInfo> {
 
     std::pair<int, bool> insert(const IsbnStr &isbn, const BookInfo &data);
     std::pair<int, bool> erase(const IsbnStr &isbn);
-    std::pair<int, bool> edit(const int pos, BookInfo data);
+    std::pair<int, bool> edit(const int pos, const IsbnStr &isbn,
+                              const BookStr &name, const BookStr &author,
+                              const std::vector<BookStr> &keyword,
+                              const Money &price);
 
-    std::pair<double, bool> import(const int pos, const int quantity, const double cost);
-    std::pair<double, bool> buy(const IsbnStr &isbn, const int quantity);
+    std::pair<Money, bool> import(const int pos, const int quantity, const Money &cost);
+    bool BulkInsert(std::vector<BookRow> &rows);
+    int reprice(const std::vector<BookIndex> &index,
+                const std::vector<BookCondition> &filter,
+                const Money *price, const double scale);
+    std::pair<Money, bool> buy(const IsbnStr &isbn, const int quantity);
+    std::pair<Money, bool>
+    buy(std::vector<std::pair<IsbnStr, int>> items);
     
     BookInfo FileSearchByISBN(const IsbnStr &isbn);
-    std::vector<BookInfo> FileSearchByName(const BookStr &name);
-    std::vector<BookInfo> FileSearchByAuthor(const BookStr &author);
-    std::vector<BookInfo> FileSearchByKeyword(const BookStr &keyword);
+    std::vector<BookIndex> FileSearchByName(const BookStr &name,
+                                            const BookPage &page = BookPage());
+    std::vector<BookIndex>
+    FileSearchByAuthor(const BookStr &author,
+                       const BookPage &page = BookPage());
+    std::vector<BookIndex>
+    FileSearchByKeyword(const BookStr &keyword,
+                        const BookPage &page = BookPage());
+    std::vector<BookIndex> FileSearchAll(const BookPage &page);
+    std::vector<BookIndex> FileSearchByPrice(const Money &low,
+                                             const Money &high);
+    std::vector<BookIndex> FileSearchByStock(const int threshold);
+    std::vector<BookIndex> FileSearchBestsellers(const int count);
+    std::vector<BookIndex> FileSearchByCondition(const BookCondition &cond);
+    size_t Prepare(BookCondition &cond);
+    bool Match(const BookInfo &book, const BookCondition &cond) const;
+
+    std::vector<std::string> Complete(const BookCondition::Field field,
+                                      const std::string &prefix,
+                                      const size_t limit);
+
+    void PrintInfo(const BookInfo &book, std::ostream &out = std::cout);
+    void PrintLine(const int pos, std::ostream &out = std::cout);
+    void RenderAll();
+    int PrintByIndex(const std::vector<BookIndex> &index,
+                     const std::vector<BookCondition> &filter = {},
+                     std::ostream &out = std::cout,
+                     std::vector<int> *printed = nullptr);
+    int PrintAll();
+
+    // The term of a query result, a book matching it may join the result
+    static std::string Term(const BookCondition::Field field,
+                            const std::string &value);
+    bool PrintCached(const std::string &query);
+    void PrintAndCache(const std::string &query,
+                       const std::vector<std::string> &terms,
+                       const std::vector<BookIndex> &index,
+                       const std::vector<BookCondition> &filter = {});
 
   public:
     void output();
     int siz;
 
+  private:
+    // The number of records fetched at once when printing a result
+    static const int kFetchBatch = 256;
+    // The size of catalog from which a full scan beats walking the index
+    static const int kParallelScanMin = 1 << 16;
+
+    // The number of prefixes cached for each field of completion
+    static const int kMaxCompleteCache = 1024;
+    // The number of names and their largest edit distance in a fuzzy search
+    static const int kFuzzyCount = 5;
+    static const int kFuzzyDistance = 2;
+
+    std::vector<BookIndex> FileSearchByIndex(multimap &table, const int id,
+                                             const BookPage &page = BookPage());
+    multimap &TableOf(const BookCondition::Field field);
+    bool InUse(multimap &table, const int id);
+    void Invalidate(const BookCondition::Field field, const std::string &str);
+    void InvalidateResults(const int pos, const BookInfo &book);
+    void Render(const int pos, const BookInfo &book);
+    void StoreLine(const int pos, const std::string &str);
+    static void FormatInfo(const IsbnStr &isbn, const BookStr &name,
+                           const BookStr &author,
+                           const std::vector<BookStr> &keyword,
+                           const Money &price, const int quantity,
+                           std::ostream &out);
+
+    // The cached completions of a prefix, complete if fewer than limit
+    struct CompleteResult {
+        size_t limit;
+        std::vector<std::string> items;
+    };
+
   private:
     map isbn_table;
     multimap name_table;
     multimap author_table;
     multimap key_table;
+    pricemap price_table;
+    multimap quantity_table;
+    multimap sales_table; // keyed by the negative sales of the sold books
+    dict name_dict;
+    dict author_dict;
+    dict key_dict;
+    // Completions of ISBN, name and author, indexed by the field
+    std::unordered_map<std::string, CompleteResult> complete_cache[3];
+    QueryCache query_cache;
+    file::BaseFileSystem<BookLine> line_table;
 };
 
 class BookSystem {
@@ -76,26 +262,47 @@ class BookSystem {
 
     int SelectBook(const char *isbn);
 
-    void SearchAll();
-    void SearchByISBN(const char *isbn);
-    void SearchByName(const char *name);
-    void SearchByAuthor(const char *author);
-    void SearchByKeyword(const char *keyword);
+    void SearchAll(const BookPage &page = BookPage());
+    void SearchByISBN(const char *isbn, const BookPage &page = BookPage());
+    void SearchByName(const char *name, const BookPage &page = BookPage());
+    void SearchByAuthor(const char *author, const BookPage &page = BookPage());
+    void SearchByKeyword(const char *keyword,
+                         const BookPage &page = BookPage());
+    void SearchByConditions(std::vector<BookCondition> conds,
+                            const BookPage &page = BookPage());
+    void SearchByPrice(const Money &low, const Money &high);
+    void SearchLowStock(const int threshold);
+    void SearchBestsellers(const int count);
+    void CompleteBook(const BookCondition::Field field, const char *prefix,
+                      const int limit);
 
     void BuyBook(const char *isbn, const int quantity);
+    void BuyCart(const std::vector<std::pair<IsbnStr, int>> &items);
 
-    void ModifyBook(const int book_pos, const char *_isbn, const char *_name, const char *_author, const std::vector<BookStr> &_key, const double _price);
-    void ImportBook(const int book_pos, const int quantity, const double cost);
+    void ModifyBook(const int book_pos, const char *_isbn, const char *_name, const char *_author, const std::vector<BookStr> &_key, const Money &_price);
+    void ImportBook(const int book_pos, const int quantity, const Money &cost);
+    int BulkLoad(const char *file_name);
+    int Reprice(std::vector<BookCondition> conds, const Money *price,
+                const double scale);
 
     void ShowFinance(const int rev = -1);
+    void ShowFinance(const long long since, const long long until);
+
+  protected:
+    // The cost of fetching a record compared with reading an index entry
+    static const int kFetchCost = 16;
 
   protected:
     void output();
+    void PrintPage(const std::vector<BookIndex> &index, const BookPage &page);
+    std::vector<BookIndex> Resolve(std::vector<BookCondition> &conds,
+                                   std::vector<BookCondition> &filter,
+                                   const bool with_filter);
     void AddBook(const char *isbn, const BookInfo &data);
 
   private:
     BookFileSystem book_table;
-    std::vector<double> total_earn, total_cost;
+    FinanceLog finance_log;
 };
 
 } // namespace book
@@ -0,0 +1,139 @@
+#include "FinanceLog.h"
+
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+
+namespace bookstore {
+
+namespace book {
+
+FinanceRollup::FinanceRollup(const std::string &_file_name,
+                             const long long _width)
+    : bucket_table(_file_name), bucket_width(_width) {
+    siz = std::filesystem::file_size("data/" + _file_name + ".dat") /
+          sizeof(Bucket);
+    if (siz)
+        tail = bucket_table.find(siz);
+}
+
+// Add a transaction at the given time, which is not before the last one
+void FinanceRollup::add(const long long stamp, const Money &earn,
+                        const Money &cost) {
+    long long id = stamp / bucket_width;
+    if (id != tail.id) {
+        tail.id = id;
+        siz++;
+    }
+    tail.earn += earn;
+    tail.cost += cost;
+    bucket_table.insert(siz, tail);
+    bucket_table.flush();
+}
+
+/**
+ * @brief Get the totals of the transactions before the given time
+ * @details The time should be at the start of a bucket. The last bucket before
+ * it is found by a binary search, which reads O(log n) buckets.
+ * @param stamp
+ * @return std::pair<Money, Money> (the earning and the cost)
+ */
+std::pair<Money, Money> FinanceRollup::before(const long long stamp) {
+    long long id = stamp / bucket_width;
+    if (siz && tail.id < id)
+        return std::make_pair(tail.earn, tail.cost);
+    int l = 1, r = siz, pos = 0;
+    while (l <= r) {
+        int mid = (l + r) >> 1;
+        if (bucket_table.find(mid).id < id)
+            pos = mid, l = mid + 1;
+        else
+            r = mid - 1;
+    }
+    if (!pos)
+        return std::make_pair(Money(), Money());
+    Bucket cur = bucket_table.find(pos);
+    return std::make_pair(cur.earn, cur.cost);
+}
+
+FinanceLog::FinanceLog(const std::string &_file_name)
+    : entry_table(_file_name), hourly(_file_name + "_hour", kHour),
+      daily(_file_name + "_day", kDay) {
+    siz = std::filesystem::file_size("data/" + _file_name + ".dat") /
+          sizeof(Entry);
+    if (siz)
+        tail = entry_table.find(siz);
+}
+
+/**
+ * @brief Append a transaction
+ * @details The entry is written through at once, so no transaction is lost if
+ * the program is not closed normally. A transaction never goes before the last
+ * one, even if the clock does, so the rollups stay in order.
+ * @param earn
+ * @param cost
+ * @param stamp (the time of the transaction)
+ */
+void FinanceLog::push(const Money &earn, const Money &cost,
+                      const long long stamp) {
+    tail.earn += earn;
+    tail.cost += cost;
+    tail.stamp = std::max(tail.stamp, stamp);
+    entry_table.insert(++siz, tail);
+    entry_table.flush();
+    hourly.add(tail.stamp, earn, cost);
+    daily.add(tail.stamp, earn, cost);
+}
+
+/**
+ * @brief Get the total earning and cost of the last transactions
+ * @param count (no more than size())
+ * @return std::pair<Money, Money> (the earning and the cost)
+ */
+std::pair<Money, Money> FinanceLog::sum(const int count) {
+    Entry head = at(siz - count);
+    return std::make_pair(tail.earn - head.earn, tail.cost - head.cost);
+}
+
+/**
+ * @brief Get the total earning and cost in a period of time
+ * @details The period is answered by the daily rollup if both ends are at the
+ * start of a day, or by the hourly one otherwise.
+ * @param since (included, at the start of an hour)
+ * @param until (excluded, at the start of an hour)
+ * @return std::pair<Money, Money> (the earning and the cost)
+ */
+std::pair<Money, Money> FinanceLog::sum(const long long since,
+                                        const long long until) {
+    if (since >= until)
+        return std::make_pair(Money(), Money());
+    FinanceRollup &rollup =
+        since % kDay == 0 && (until == LLONG_MAX || until % kDay == 0)
+            ? daily
+            : hourly;
+    auto head = rollup.before(since), end = rollup.before(until);
+    return std::make_pair(end.first - head.first, end.second - head.second);
+}
+
+long long FinanceLog::ParseTime(const std::string &str) {
+    std::tm time = {};
+    time.tm_year = std::stoi(str.substr(0, 4)) - 1900;
+    time.tm_mon = std::stoi(str.substr(5, 2)) - 1;
+    time.tm_mday = std::stoi(str.substr(8, 2));
+    if (str.size() > 10)
+        time.tm_hour = std::stoi(str.substr(11, 2));
+    return timegm(&time);
+}
+
+// Get the prefix sums up to the index-th transaction
+FinanceLog::Entry FinanceLog::at(const int index) {
+    if (!index)
+        return Entry();
+    if (index == siz)
+        return tail;
+    return entry_table.find(index);
+}
+
+} // namespace book
+
+} // namespace bookstore
@@ -0,0 +1,93 @@
+#ifndef BOOKSTORE_FINANCELOG_H
+#define BOOKSTORE_FINANCELOG_H
+
+#include <ctime>
+#include <string>
+#include <utility>
+
+#include "Files/FileSystem.h"
+#include "Utils/Money.h"
+
+namespace bookstore {
+
+namespace book {
+
+/**
+ * @brief Class FinanceRollup
+ * @details The totals of the transactions grouped into buckets of a fixed
+ * width of time, stored on disk as prefix sums in the order of bucket. Only
+ * the last bucket is rewritten by a new transaction, and the totals before any
+ * time are found by a binary search over the buckets.
+ */
+class FinanceRollup {
+  public:
+    FinanceRollup(const std::string &_file_name, const long long _width);
+    ~FinanceRollup() = default;
+
+    void add(const long long stamp, const Money &earn, const Money &cost);
+    std::pair<Money, Money> before(const long long stamp);
+    long long width() const { return bucket_width; }
+
+  private:
+    class Bucket {
+      public:
+        long long id = -1; // the start time divided by the width
+        Money earn;        // the prefix sums up to the end of the bucket
+        Money cost;
+    };
+
+  private:
+    file::BaseFileSystem<Bucket> bucket_table;
+    Bucket tail; // the last bucket
+    int siz;
+    long long bucket_width;
+};
+
+/**
+ * @brief Class FinanceLog
+ * @details An append-only ledger of the transactions, stored on disk as the
+ * prefix sums of earning and cost with the time of each transaction. The entry
+ * of the i-th transaction is kept at position i, and only the last one is
+ * cached, so the sums of the last transactions are answered by reading a
+ * single entry. The hourly and daily rollups are kept along with it for the
+ * queries over a period of time.
+ */
+class FinanceLog {
+  public:
+    explicit FinanceLog(const std::string &_file_name);
+    ~FinanceLog() = default;
+
+    void push(const Money &earn, const Money &cost,
+              const long long stamp = std::time(nullptr));
+    std::pair<Money, Money> sum(const int count);
+    std::pair<Money, Money> sum(const long long since, const long long until);
+    int size() const { return siz; }
+
+    // Parse a validated UTC time in the form YYYY-MM-DD or YYYY-MM-DDTHH
+    static long long ParseTime(const std::string &str);
+
+    static const long long kHour = 3600;
+    static const long long kDay = 86400;
+
+  private:
+    class Entry {
+      public:
+        Money earn;
+        Money cost;
+        long long stamp = 0;
+    };
+
+    Entry at(const int index);
+
+  private:
+    file::BaseFileSystem<Entry> entry_table;
+    Entry tail; // the entry of the last transaction
+    int siz;
+    FinanceRollup hourly, daily;
+};
+
+} // namespace book
+
+} // namespace bookstore
+
+#endif
@@ -0,0 +1,104 @@
+#include "QueryCache.h"
+
+namespace bookstore {
+
+namespace book {
+
+/**
+ * @brief Get the cached result of a query
+ * @param query
+ * @return const std::string* (nullptr if not cached)
+ */
+const std::string *QueryCache::find(const std::string &query) {
+    auto it = table.find(query);
+    if (it == table.end())
+        return nullptr;
+    entries.splice(entries.begin(), entries, it->second); // mark it as used
+    return &it->second->result;
+}
+
+/**
+ * @brief Cache the result of a query
+ * @details A result larger than a sixteenth of the budget is not cached. The
+ * least recently used results are dropped when the cache is full.
+ * @param query
+ * @param result (the rendered output)
+ * @param positions (the books in the result)
+ * @param terms (the terms a book must match to be in the result)
+ */
+void QueryCache::insert(const std::string &query, const std::string &result,
+                        const std::vector<int> &positions,
+                        const std::vector<std::string> &terms) {
+    erase(query);
+    if (result.size() > max_bytes / 16)
+        return;
+    entries.push_front(Entry{query, result, positions, terms});
+    table[query] = entries.begin();
+    bytes += result.size();
+    for (int pos : positions)
+        book_queries[pos].insert(query);
+    for (const auto &term : terms)
+        term_queries[term].insert(query);
+    while (entries.size() > max_entries || bytes > max_bytes)
+        erase(entries.back().query);
+}
+
+// Drop the results containing the book at pos
+void QueryCache::InvalidateBook(const int pos) {
+    auto it = book_queries.find(pos);
+    if (it == book_queries.end())
+        return;
+    std::unordered_set<std::string> queries;
+    queries.swap(it->second);
+    for (const auto &query : queries)
+        erase(query);
+}
+
+// Drop the results of the queries with the term
+void QueryCache::InvalidateTerm(const std::string &term) {
+    auto it = term_queries.find(term);
+    if (it == term_queries.end())
+        return;
+    std::unordered_set<std::string> queries;
+    queries.swap(it->second);
+    for (const auto &query : queries)
+        erase(query);
+}
+
+void QueryCache::clear() {
+    entries.clear();
+    table.clear();
+    book_queries.clear();
+    term_queries.clear();
+    bytes = 0;
+}
+
+void QueryCache::erase(const std::string &query) {
+    auto it = table.find(query);
+    if (it == table.end())
+        return;
+    Entry &entry = *it->second;
+    for (int pos : entry.positions) {
+        auto cur = book_queries.find(pos);
+        if (cur == book_queries.end())
+            continue;
+        cur->second.erase(query);
+        if (cur->second.empty())
+            book_queries.erase(cur);
+    }
+    for (const auto &term : entry.terms) {
+        auto cur = term_queries.find(term);
+        if (cur == term_queries.end())
+            continue;
+        cur->second.erase(query);
+        if (cur->second.empty())
+            term_queries.erase(cur);
+    }
+    bytes -= entry.result.size();
+    entries.erase(it->second);
+    table.erase(it);
+}
+
+} // namespace book
+
+} // namespace bookstore
@@ -0,0 +1,64 @@
+#ifndef BOOKSTORE_QUERYCACHE_H
+#define BOOKSTORE_QUERYCACHE_H
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace bookstore {
+
+namespace book {
+
+/**
+ * @brief Class QueryCache
+ * @details A bounded LRU cache of the rendered results of queries. Each result
+ * is also registered under the positions of the books it contains and the
+ * terms (field and value) of its query, so that a changed book only drops the
+ * results containing it, or those it may newly satisfy.
+ */
+class QueryCache {
+  public:
+    explicit QueryCache(const size_t _max_entries = kMaxEntries,
+                        const size_t _max_bytes = kMaxBytes)
+        : max_entries(_max_entries), max_bytes(_max_bytes), bytes(0) {}
+    ~QueryCache() = default;
+
+    const std::string *find(const std::string &query);
+    void insert(const std::string &query, const std::string &result,
+                const std::vector<int> &positions,
+                const std::vector<std::string> &terms);
+    void InvalidateBook(const int pos);
+    void InvalidateTerm(const std::string &term);
+    void clear();
+
+  private:
+    static const size_t kMaxEntries = 1024;
+    static const size_t kMaxBytes = 16 << 20;
+
+    class Entry {
+      public:
+        std::string query;
+        std::string result;
+        std::vector<int> positions;
+        std::vector<std::string> terms;
+    };
+    using Iterator = std::list<Entry>::iterator;
+
+    void erase(const std::string &query);
+
+  private:
+    size_t max_entries, max_bytes, bytes;
+    std::list<Entry> entries; // the most recently used first
+    std::unordered_map<std::string, Iterator> table;
+    std::unordered_map<int, std::unordered_set<std::string>> book_queries;
+    std::unordered_map<std::string, std::unordered_set<std::string>>
+        term_queries;
+};
+
+} // namespace book
+
+} // namespace bookstore
+
+#endif
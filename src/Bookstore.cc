@@ -3,9 +3,11 @@
 #include "Log/LogSystem.h"
 #include "User/UserSystem.h"
 #include "Utils/Exception.h"
+#include "Utils/Money.h"
 
 #include <algorithm>
 #include <cctype>
+#include <climits>
 #include <string>
 #include <utility>
 
@@ -83,35 +85,15 @@ int to_authentity(const input::Function &func) {
         return 0;
     if (func == LOGOUT || func == PASSWD || func == SHOW_ALL ||
         func == SHOW_ISBN || func == SHOW_NAME || func == SHOW_AUTHOR ||
-        func == SHOW_KEYWORD || func == BUY)
+        func == SHOW_KEYWORD || func == SHOW_QUERY || func == SHOW_PRICE ||
+        func == SHOW_BESTSELLERS || func == COMPLETE || func == BUY)
         return 1;
-    if (func == USERADD || func == SEL || func == MODIFY || func == IMPORT)
+    if (func == USERADD || func == SEL || func == MODIFY || func == IMPORT ||
+        func == BULKLOAD || func == SHOW_STOCK)
         return 3;
     return 7;
 }
 
-double str_to_double(const std::string str) {
-    if (str == "-1")
-        return -1.0;
-    double tcost1 = 0, tcost2 = 0, tcost_div = 1.0;
-    bool dot_flag = 0;
-    for (const char &ch : str) {
-        if (ch == '.')
-            dot_flag = 1;
-        else {
-            if (!dot_flag)
-                tcost1 = tcost1 * 10.0 + (double)(ch - '0');
-            else {
-                tcost2 = tcost2 * 10.0 + (double)(ch - '0');
-                tcost_div *= 10.0;
-            }
-        }
-    }
-    if (dot_flag)
-        tcost1 += tcost2 / tcost_div;
-    return tcost1;
-}
-
 bool validate(const std::string &str) {
     for (const char &ch : str) {
         if (!(isalpha(ch) || isdigit(ch) || ch == '_'))
@@ -120,59 +102,158 @@ bool validate(const std::string &str) {
     return true;
 }
 
-void Bookstore::AcceptMsg(const input::BookstoreParser &msg) {
+// Get the page from the pairs of paging options in args from beg
+book::BookPage ParsePage(const input::BookstoreLexer &args, const int beg) {
+    book::BookPage page;
+    for (int i = beg; i + 1 < args.size(); i += 2) {
+        if (args[i] == "-limit")
+            page.limit = std::stoi(args[i + 1]);
+        else if (args[i] == "-offset")
+            page.offset = std::stoi(args[i + 1]);
+        else if (args[i] == "-cursor")
+            page.after = book::BookPage::Decode(args[i + 1]);
+    }
+    return page;
+}
+
+// Get the conditions from the pairs of options and values in args before end
+std::vector<book::BookCondition> ParseConditions(const input::BookstoreLexer &args,
+                                                 const int end) {
+    using book::BookCondition;
+    std::vector<BookCondition> conds;
+    for (int i = 0; i + 1 < end; i += 2) {
+        if (args[i] == "-ISBN")
+            conds.push_back(BookCondition(BookCondition::ISBN));
+        else if (args[i] == "-name")
+            conds.push_back(BookCondition(BookCondition::NAME));
+        else if (args[i] == "-author")
+            conds.push_back(BookCondition(BookCondition::AUTHOR));
+        else if (args[i] == "-name*")
+            conds.push_back(BookCondition(BookCondition::NAME_PART));
+        else if (args[i] == "-author*")
+            conds.push_back(BookCondition(BookCondition::AUTHOR_PART));
+        else if (args[i] == "-name~")
+            conds.push_back(BookCondition(BookCondition::NAME_FUZZY));
+        else {
+            // Keywords separated by '|' are alternatives
+            if (args[i + 1].back() == '|')
+                throw InvalidException("Invalid keyword");
+            conds.push_back(BookCondition(BookCondition::KEYWORD));
+            for (std::string str : input::BookstoreLexer(args[i + 1], '|')) {
+                if (!str.size())
+                    throw InvalidException("Check length");
+                conds.back().values.push_back(str);
+            }
+            continue;
+        }
+        conds.back().values.push_back(args[i + 1]);
+    }
+    return conds;
+}
+
+void Bookstore::AcceptMsg(user::Session &session,
+                          const input::BookstoreParser &msg) {
     using namespace input;
     std::pair<std::string, int> cur, tmp;
-    cur = std::make_pair(UserSystem::GetName(), UserSystem::GetIdentity());
+    cur = std::make_pair(UserSystem::GetName(session),
+                         UserSystem::GetIdentity(session));
     if (cur.second < to_authentity(msg.func))
         throw InvalidException("Check authority");
     if (msg.func == QUIT) {
         throw NormalException(QUIT_SYSTEM);
     } else if (msg.func == SU) {
-        UserSystem::UserLogin(msg.args[0].c_str(), msg.args[1].c_str());
-        tmp = std::make_pair(UserSystem::GetName(), UserSystem::GetIdentity());
+        UserSystem::UserLogin(session, msg.args[0].c_str(),
+                              msg.args[1].c_str());
+        tmp = std::make_pair(UserSystem::GetName(session),
+                             UserSystem::GetIdentity(session));
     } else if (msg.func == LOGOUT) {
-        UserSystem::UserLogout();
+        UserSystem::UserLogout(session);
     } else if (msg.func == REG) {
         UserSystem::UserRegister(msg.args[0].c_str(), msg.args[2].c_str(),
                                  msg.args[1].c_str());
         tmp = std::make_pair(msg.args[0], 1);
     } else if (msg.func == PASSWD) {
-        int ret = UserSystem::ModifyPassword(
-            msg.args[0].c_str(), msg.args[1].c_str(), msg.args[2].c_str());
+        int ret = UserSystem::ModifyPassword(session, msg.args[0].c_str(),
+                                             msg.args[1].c_str(),
+                                             msg.args[2].c_str());
         tmp = std::make_pair(msg.args[0], ret);
     } else if (msg.func == USERADD) {
-        UserSystem::UserAdd(msg.args[0].c_str(), msg.args[3].c_str(),
-                            msg.args[1].c_str(), std::stoi(msg.args[2]));
+        UserSystem::UserAdd(session, msg.args[0].c_str(),
+                            msg.args[3].c_str(), msg.args[1].c_str(),
+                            std::stoi(msg.args[2]));
         tmp = std::make_pair(msg.args[0], std::stoi(msg.args[2]));
     } else if (msg.func == DEL) {
-        int ret = UserSystem::UserErase(msg.args[0].c_str());
+        int ret = UserSystem::UserErase(session, msg.args[0].c_str());
         tmp = std::make_pair(msg.args[0], ret);
     } else if (msg.func == FINANCE) {
-        if (msg.args.size()) {
+        if (msg.args.size() && msg.args[0][0] == '-') {
+            long long since = 0, until = LLONG_MAX;
+            for (int i = 0; i < msg.args.size(); i += 2) {
+                if (msg.args[i] == "-since")
+                    since = book::FinanceLog::ParseTime(msg.args[i + 1]);
+                else
+                    until = book::FinanceLog::ParseTime(msg.args[i + 1]);
+            }
+            BookSystem::ShowFinance(since, until);
+        } else if (msg.args.size()) {
             BookSystem::ShowFinance(std::stoi(msg.args[0]));
         } else
             BookSystem::ShowFinance();
     } else if (msg.func == SHOW_ALL) {
-        BookSystem::SearchAll();
+        BookSystem::SearchAll(ParsePage(msg.args, 0));
     } else if (msg.func == SHOW_ISBN) {
-        BookSystem::SearchByISBN(msg.args[0].c_str());
+        BookSystem::SearchByISBN(msg.args[0].c_str(), ParsePage(msg.args, 1));
     } else if (msg.func == SHOW_NAME) {
-        BookSystem::SearchByName(msg.args[0].c_str());
+        BookSystem::SearchByName(msg.args[0].c_str(), ParsePage(msg.args, 1));
     } else if (msg.func == SHOW_AUTHOR) {
-        BookSystem::SearchByAuthor(msg.args[0].c_str());
+        BookSystem::SearchByAuthor(msg.args[0].c_str(),
+                                   ParsePage(msg.args, 1));
         return;
     } else if (msg.func == SHOW_KEYWORD) {
-        if (msg.args[0].find('|') != std::string::npos)
-            throw InvalidException("More than one keywords in show");
-        BookSystem::SearchByKeyword(msg.args[0].c_str());
+        BookSystem::SearchByKeyword(msg.args[0].c_str(),
+                                    ParsePage(msg.args, 1));
+    } else if (msg.func == SHOW_QUERY) {
+        int page_beg = msg.args.size();
+        for (int i = 0; i < msg.args.size(); i += 2) {
+            if (msg.args[i] == "-limit" || msg.args[i] == "-offset" ||
+                msg.args[i] == "-cursor") {
+                page_beg = i;
+                break;
+            }
+        }
+        std::vector<book::BookCondition> conds =
+            ParseConditions(msg.args, page_beg);
+        BookSystem::SearchByConditions(conds, ParsePage(msg.args, page_beg));
+    } else if (msg.func == SHOW_PRICE) {
+        BookSystem::SearchByPrice(Money::Parse(msg.args[0]),
+                                  Money::Parse(msg.args[1]));
+    } else if (msg.func == SHOW_STOCK) {
+        BookSystem::SearchLowStock(std::stoi(msg.args[0]));
+    } else if (msg.func == SHOW_BESTSELLERS) {
+        BookSystem::SearchBestsellers(std::stoi(msg.args[0]));
+    } else if (msg.func == COMPLETE) {
+        book::BookCondition::Field field =
+            msg.args[0] == "-ISBN"   ? book::BookCondition::ISBN
+            : msg.args[0] == "-name" ? book::BookCondition::NAME
+                                     : book::BookCondition::AUTHOR;
+        BookSystem::CompleteBook(field, msg.args[1].c_str(),
+                                 std::stoi(msg.args[2]));
     } else if (msg.func == BUY) {
-        BookSystem::BuyBook(msg.args[0].c_str(), std::stoi(msg.args[1]));
+        if (msg.args.size() == 2)
+            BookSystem::BuyBook(msg.args[0].c_str(), std::stoi(msg.args[1]));
+        else {
+            std::vector<std::pair<book::IsbnStr, int>> items;
+            for (int i = 0; i < msg.args.size(); i += 2)
+                items.push_back(std::make_pair(
+                    book::IsbnStr(msg.args[i].c_str()),
+                    std::stoi(msg.args[i + 1])));
+            BookSystem::BuyCart(items);
+        }
     } else if (msg.func == SEL) {
         int book_pos = BookSystem::SelectBook(msg.args[0].c_str());
-        UserSystem::SelectBook(book_pos);
+        UserSystem::SelectBook(session, book_pos);
     } else if (msg.func == MODIFY) {
-        int book_pos = UserSystem::GetBook();
+        int book_pos = UserSystem::GetBook(session);
         if (!book_pos)
             throw InvalidException("Modify a book before selecting it");
         if (msg.args[3][msg.args[3].size() - 1] == '|')
@@ -192,10 +273,24 @@ void Bookstore::AcceptMsg(const input::BookstoreParser &msg) {
                 throw InvalidException("Duplicated keyword");
         BookSystem::ModifyBook(book_pos, msg.args[0].c_str(),
                                msg.args[1].c_str(), msg.args[2].c_str(),
-                               key_div, str_to_double(msg.args[4]));
+                               key_div,
+                               msg.args[4] == "-1" ? Money(-1)
+                                                   : Money::Parse(msg.args[4]));
     } else if (msg.func == IMPORT) {
-        BookSystem::ImportBook(UserSystem::GetBook(), std::stoi(msg.args[0]),
-                               str_to_double(msg.args[1]));
+        BookSystem::ImportBook(UserSystem::GetBook(session),
+                               std::stoi(msg.args[0]),
+                               Money::Parse(msg.args[1]));
+    } else if (msg.func == BULKLOAD) {
+        int cnt = BookSystem::BulkLoad(msg.args[0].c_str());
+        tmp = std::make_pair(msg.args[0], cnt);
+    } else if (msg.func == REPRICE) {
+        int end = msg.args.size() - 2;
+        Money price = Money::Parse(msg.args[end + 1]);
+        int cnt = BookSystem::Reprice(
+            ParseConditions(msg.args, end),
+            msg.args[end] == "-price" ? &price : nullptr,
+            msg.args[end] == "-scale" ? std::stod(msg.args[end + 1]) : 1.0);
+        tmp = std::make_pair(std::string(), cnt);
     } else if (msg.func == LOG) {
         system("cat data/Bookstore.log");
     } else
@@ -15,7 +15,9 @@ class Bookstore : public user::UserSystem, public book::BookSystem, public log::
     Bookstore();
     ~Bookstore();
 
-    void AcceptMsg(const input::BookstoreParser &msg);
+    using user::UserSystem::OpenSession;
+    using user::UserSystem::CloseSession;
+    void AcceptMsg(user::Session &session, const input::BookstoreParser &msg);
 
   public:
     void output();
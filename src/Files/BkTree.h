@@ -0,0 +1,142 @@
+#ifndef BOOKSTORE_BKTREE_H
+#define BOOKSTORE_BKTREE_H
+
+#include <algorithm>
+#include <filesystem>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Files/FileSystem.h"
+
+namespace bookstore {
+
+namespace file {
+
+/**
+ * @brief Class BkTree
+ * @details A persisted BK-tree over the strings of a dictionary, measured by
+ * the edit distance. The node of the string with id x is stored at position x,
+ * and the children of a node are chained by sibling links, so inserting a
+ * string only rewrites two nodes. The strings themselves are kept by the
+ * dictionary and read by the given lookup.
+ */
+class BkTree {
+  public:
+    explicit BkTree(const std::string &_file_name) : node_table(_file_name) {
+        siz = std::filesystem::file_size("data/" + _file_name + ".dat") /
+              sizeof(Node);
+    }
+    ~BkTree() = default;
+
+    // Add the string with the next id, str is lookup(id)
+    template <class Lookup>
+    void insert(const int id, const std::string &str, Lookup lookup) {
+        siz = id;
+        node_table.insert(id, Node());
+        if (id == 1) // the root
+            return;
+        int cur = 1;
+        while (true) {
+            int dis = Distance(lookup(cur), str);
+            Node cur_node = node_table.find(cur);
+            int child = cur_node.child;
+            while (child) {
+                Node child_node = node_table.find(child);
+                if (child_node.dis == dis)
+                    break;
+                child = child_node.sibling;
+            }
+            if (!child) {
+                Node new_node;
+                new_node.dis = dis;
+                new_node.sibling = cur_node.child;
+                cur_node.child = id;
+                node_table.insert(id, new_node);
+                node_table.insert(cur, cur_node);
+                return;
+            }
+            cur = child;
+        }
+    }
+
+    /**
+     * @brief Get the k strings nearest to str within max_dis
+     * @details Walk the tree by the triangle inequality, only the children at
+     * a distance in [d - r, d + r] from the node are visited. Once k strings
+     * are found, r shrinks to the distance of the worst of them.
+     * @param keep (judge whether an id may be returned)
+     * @return std::vector<int> (the ids, nearest first)
+     */
+    template <class Lookup, class Keep>
+    std::vector<int> search(const std::string &str, const int max_dis,
+                            const size_t k, Lookup lookup, Keep keep) {
+        std::priority_queue<std::pair<int, int>> best; // (distance, id)
+        if (!siz || !k)
+            return std::vector<int>();
+        int range = max_dis;
+        std::vector<int> stack(1, 1);
+        while (!stack.empty()) {
+            int cur = stack.back();
+            stack.pop_back();
+            int dis = Distance(lookup(cur), str);
+            if (dis <= range && keep(cur)) {
+                best.push(std::make_pair(dis, cur));
+                if (best.size() > k)
+                    best.pop();
+                if (best.size() == k)
+                    range = std::min(range, best.top().first);
+            }
+            for (int child = node_table.find(cur).child; child;) {
+                Node child_node = node_table.find(child);
+                if (child_node.dis >= dis - range &&
+                    child_node.dis <= dis + range)
+                    stack.push_back(child);
+                child = child_node.sibling;
+            }
+        }
+        std::vector<int> ret(best.size());
+        for (int i = ret.size() - 1; i >= 0; i--)
+            ret[i] = best.top().second, best.pop();
+        return ret;
+    }
+
+    int size() const { return siz; }
+
+    // The edit distance between two strings
+    static int Distance(const std::string &a, const std::string &b) {
+        std::vector<int> dp(b.size() + 1);
+        for (int j = 0; j <= b.size(); j++)
+            dp[j] = j;
+        for (int i = 1; i <= a.size(); i++) {
+            int las = dp[0]; // dp[i - 1][j - 1]
+            dp[0] = i;
+            for (int j = 1; j <= b.size(); j++) {
+                int tmp = dp[j];
+                dp[j] = std::min({dp[j] + 1, dp[j - 1] + 1,
+                                  las + (a[i - 1] != b[j - 1])});
+                las = tmp;
+            }
+        }
+        return dp[b.size()];
+    }
+
+  private:
+    class Node {
+      public:
+        int child = 0;   // the id of the first child
+        int sibling = 0; // the id of the next child of the parent
+        int dis = 0;     // the distance to the parent
+    };
+
+  private:
+    BaseFileSystem<Node> node_table;
+    int siz;
+};
+
+} // namespace file
+
+} // namespace bookstore
+
+#endif
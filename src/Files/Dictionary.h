@@ -0,0 +1,211 @@
+#ifndef BOOKSTORE_DICTIONARY_H
+#define BOOKSTORE_DICTIONARY_H
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Files/BkTree.h"
+#include "Files/FileSystem.h"
+#include "List/PostingList.h"
+#include "List/UnrolledLinkedList.h"
+#include "Utils/Exception.h"
+
+namespace bookstore {
+
+namespace file {
+
+/**
+ * @brief Class Dictionary
+ * @details Intern each distinct string into a dense id starting from 1, the id
+ * 0 is reserved for the empty string. The string -> id map is kept in an ull,
+ * and the id -> string map is a plain record file indexed by the id.
+ * Optionally an inverted index from trigrams to ids is kept for substring
+ * search, and a BK-tree over the strings for typo-tolerant search.
+ */
+template <size_t kMaxLen> class Dictionary {
+  public:
+    using StrType = list::KeyType<kMaxLen>;
+
+    explicit Dictionary(const std::string &_file_name,
+                        const bool with_gram = false,
+                        const bool with_fuzzy = false)
+        : id_table(_file_name + "_id"), str_table(_file_name + "_dict") {
+        siz = std::filesystem::file_size("data/" + _file_name + "_dict.dat") /
+              sizeof(StrType);
+        if (with_gram)
+            gram_table = std::make_unique<list::UnrolledLinkedList<int>>(
+                _file_name + "_gram");
+        if (with_fuzzy) {
+            bk_tree = std::make_unique<BkTree>(_file_name + "_bk");
+            // Catch up with the strings interned before the tree existed
+            for (int id = bk_tree->size() + 1; id <= siz; id++)
+                bk_tree->insert(id, lookup(id).str, Lookup());
+        }
+    }
+    ~Dictionary() = default;
+
+    // Get the id of str, create a new one if not exists
+    int intern(const StrType &str) {
+        if (str.empty())
+            return 0;
+        try {
+            id_table.insert(str, siz + 1);
+            siz++;
+            str_table.insert(siz, str);
+            if (gram_table)
+                for (int gram : Grams(str.str))
+                    gram_table->insert(gram, siz);
+            if (bk_tree)
+                bk_tree->insert(siz, str.str, Lookup());
+            return siz;
+        } catch (const NormalException &x) {
+            if (x.what() == ULL_INSERTED)
+                return id_table.find(str);
+            else {
+                x.error();
+                exit(-1);
+            }
+        }
+    }
+
+    // Get the ids of a batch of strings, the new ones are created together
+    std::vector<int> intern(const std::vector<StrType> &strs) {
+        std::vector<int> ret = id_table.bulk_find(strs);
+        std::vector<size_t> fresh;
+        for (size_t i = 0; i < strs.size(); i++)
+            if (!ret[i] && !strs[i].empty())
+                fresh.push_back(i);
+        std::sort(fresh.begin(), fresh.end(), [&strs](size_t x, size_t y) {
+            return strs[x] < strs[y];
+        });
+        std::vector<list::DataType<StrType>> new_ids;
+        std::vector<list::DataType<int>> new_grams;
+        for (size_t k = 0; k < fresh.size(); k++) {
+            const StrType &str = strs[fresh[k]];
+            if (k && str == strs[fresh[k - 1]]) { // repeated in the batch
+                ret[fresh[k]] = siz;
+                continue;
+            }
+            ret[fresh[k]] = ++siz;
+            new_ids.push_back(list::DataType<StrType>(str, siz));
+            str_table.insert(siz, str);
+            if (gram_table)
+                for (int gram : Grams(str.str))
+                    new_grams.push_back(list::DataType<int>(gram, siz));
+            if (bk_tree)
+                bk_tree->insert(siz, str.str, Lookup());
+        }
+        id_table.bulk_insert(new_ids);
+        if (gram_table)
+            gram_table->bulk_insert(new_grams);
+        return ret;
+    }
+
+    // Get the id of str, return 0 if not exists
+    int find(const StrType &str) {
+        if (str.empty())
+            return 0;
+        try {
+            return id_table.find(str);
+        } catch (const NormalException &x) {
+            if (x.what() == ULL_NOT_FOUND)
+                return 0;
+            else {
+                x.error();
+                exit(-1);
+            }
+        }
+    }
+
+    // Get the string of the given id
+    StrType lookup(const int id) {
+        if (!id)
+            return StrType();
+        return str_table.find(id);
+    }
+
+    // Get the ids of all the strings containing frag, in ascending order
+    std::vector<int> FindSubstring(const std::string &frag) {
+        std::vector<int> ret;
+        if (!gram_table || frag.size() < kGramLen) {
+            // Too short to use the trigrams, scan the distinct strings
+            for (int id = 1; id <= siz; id++)
+                if (strstr(str_table.find(id).str, frag.c_str()))
+                    ret.push_back(id);
+            return ret;
+        }
+        std::vector<int> grams = Grams(frag.c_str());
+        std::sort(grams.begin(), grams.end(), [this](int x, int y) {
+            return gram_table->estimate(x) < gram_table->estimate(y);
+        });
+        ret = gram_table->find(grams[0]);
+        for (int i = 1; i < grams.size() && !ret.empty(); i++)
+            ret = list::Intersect(ret, gram_table->find(grams[i]));
+        // The trigrams may appear in a different order, so check the strings
+        ret.erase(std::remove_if(ret.begin(), ret.end(),
+                                 [&](int id) {
+                                     return !strstr(str_table.find(id).str,
+                                                    frag.c_str());
+                                 }),
+                  ret.end());
+        return ret;
+    }
+
+    // Get the ids of the k strings nearest to str within max_dis, nearest
+    // first, skipping the ids rejected by keep
+    template <class Keep>
+    std::vector<int> FindSimilar(const std::string &str, const int max_dis,
+                                 const size_t k, Keep keep) {
+        if (!bk_tree)
+            return std::vector<int>();
+        return bk_tree->search(str, max_dis, k, Lookup(), keep);
+    }
+
+    // Get at most limit strings not less than from, with their ids
+    std::vector<list::DataType<StrType>>
+    scan(const list::DataType<StrType> &from, const size_t limit) {
+        return id_table.scan(from, limit);
+    }
+
+    int size() const { return siz; }
+
+  private:
+    static const size_t kGramLen = 3;
+
+    // Read the string of an id for the BK-tree
+    auto Lookup() {
+        return [this](const int id) { return std::string(lookup(id).str); };
+    }
+
+    // Get the distinct trigrams of str, each packed into an int
+    static std::vector<int> Grams(const char *str) {
+        std::vector<int> ret;
+        size_t len = strlen(str);
+        for (size_t i = 0; i + kGramLen <= len; i++) {
+            int gram = 0;
+            for (size_t j = 0; j < kGramLen; j++)
+                gram = gram << 8 | (unsigned char)str[i + j];
+            ret.push_back(gram);
+        }
+        std::sort(ret.begin(), ret.end());
+        ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+        return ret;
+    }
+
+  private:
+    list::UnrolledLinkedListUnique<StrType> id_table;
+    BaseFileSystem<StrType> str_table;
+    std::unique_ptr<list::UnrolledLinkedList<int>> gram_table;
+    std::unique_ptr<BkTree> bk_tree;
+    int siz;
+};
+
+} // namespace file
+
+} // namespace bookstore
+
+#endif
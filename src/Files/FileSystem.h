@@ -4,7 +4,6 @@
 #include <filesystem>
 #include <fstream>
 #include <ostream>
-#include <set>
 #include <string>
 
 namespace bookstore {
@@ -38,19 +37,8 @@ template <class DataType> class BaseFileSystem {
         file.read(reinterpret_cast<char *>(&ret), sizeof(DataType));
         return ret;
     }
-    std::set<DataType> search() {
-        std::set<DataType> ret;
-        ret.clear();
-        file.seekg(0);
-        while (!file.eof()) {
-            DataType tmp;
-            file.read(reinterpret_cast<char *>(&tmp), sizeof(DataType));
-            if (!tmp.empty())
-                ret.insert(tmp);
-        }
-        file.clear();
-        return ret;
-    }
+    // Write the buffered data into the file, before reading it elsewhere
+    void flush() { file.flush(); }
 
   private:
     std::fstream file;
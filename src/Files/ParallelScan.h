@@ -0,0 +1,196 @@
+#ifndef BOOKSTORE_PARALLELSCAN_H
+#define BOOKSTORE_PARALLELSCAN_H
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Utils/Exception.h"
+
+namespace bookstore {
+
+namespace file {
+
+/**
+ * @brief Class ParallelScanner
+ * @details Read a whole record file in sorted order. The file is split into
+ * runs which are read with pread and sorted on worker threads, then k-way
+ * merged into the output. When the file is larger than the memory budget, the
+ * sorted runs are spilled into temporary files and merged from there. If the
+ * file cannot be read in full, the scan fails before any record is output.
+ */
+template <class DataType, class Compare = std::less<DataType>>
+class ParallelScanner {
+  public:
+    explicit ParallelScanner(const std::string &_file_name,
+                             const size_t _memory_budget = kDefaultBudget)
+        : file_name("data/" + _file_name + ".dat"),
+          memory_budget(std::max(_memory_budget, sizeof(DataType) * 1024)) {
+        thread_cnt = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Call func on every non-empty record in the order of Compare, return
+    // false without calling it if the file cannot be read
+    template <class Func> bool scan(Func func) {
+        std::error_code err;
+        size_t rec_cnt = std::filesystem::file_size(file_name, err) / kRecSize;
+        if (err)
+            return false;
+        if (!rec_cnt)
+            return true;
+        int fd = open(file_name.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        size_t budget = memory_budget / kRecSize; // in records
+        bool spill = rec_cnt > budget;
+        size_t run_len = spill ? std::max<size_t>(budget / thread_cnt, 1)
+                               : (rec_cnt + thread_cnt - 1) / thread_cnt;
+        size_t run_cnt = (rec_cnt + run_len - 1) / run_len;
+        std::vector<Run> runs(run_cnt);
+
+        // Read and sort the runs on the workers
+        std::atomic<size_t> next_run(0);
+        std::atomic<bool> failed(false);
+        auto worker = [&]() {
+            std::vector<DataType> buf;
+            size_t id;
+            while (!failed && (id = next_run++) < run_cnt) {
+                size_t beg = id * run_len;
+                size_t len = std::min(run_len, rec_cnt - beg);
+                buf.resize(len);
+                if (!ReadAll(fd, buf.data(), len * kRecSize, beg * kRecSize)) {
+                    failed = true;
+                    break;
+                }
+                buf.erase(std::remove_if(buf.begin(), buf.end(),
+                                         [](DataType &x) { return x.empty(); }),
+                          buf.end());
+                std::sort(buf.begin(), buf.end(), Compare());
+                if (!spill)
+                    runs[id].data.swap(buf);
+                else if (!runs[id].Spill(file_name, id, buf))
+                    failed = true;
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int i = 0; i < thread_cnt; i++)
+            workers.emplace_back(worker);
+        for (auto &t : workers)
+            t.join();
+        close(fd);
+        if (failed) {
+            for (auto &run : runs)
+                run.Close();
+            return false;
+        }
+
+        // Merge the sorted runs
+        size_t buf_len = std::max<size_t>(budget / run_cnt, 1);
+        auto cmp = [&runs](const size_t x, const size_t y) {
+            return Compare()(runs[y].front(), runs[x].front());
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(cmp)> heap(
+            cmp);
+        for (size_t i = 0; i < run_cnt; i++)
+            if (runs[i].Fill(buf_len))
+                heap.push(i);
+        while (!heap.empty()) {
+            size_t id = heap.top();
+            heap.pop();
+            func(runs[id].front());
+            runs[id].cur++;
+            if (runs[id].Fill(buf_len))
+                heap.push(id);
+        }
+        for (auto &run : runs)
+            run.Close();
+        return true;
+    }
+
+  private:
+    static constexpr size_t kRecSize = sizeof(DataType);
+    static constexpr size_t kDefaultBudget = 64 << 20;
+
+    // Read len bytes at offset, retrying on short reads, return false if the
+    // file ends or fails before that
+    static bool ReadAll(int fd, void *buf, size_t len, off_t offset) {
+        char *ptr = reinterpret_cast<char *>(buf);
+        while (len) {
+            ssize_t ret = pread(fd, ptr, len, offset);
+            if (ret <= 0)
+                return false;
+            ptr += ret, len -= ret, offset += ret;
+        }
+        return true;
+    }
+
+    // A sorted run, either in memory or in a temporary file
+    class Run {
+      public:
+        std::vector<DataType> data;
+        size_t cur = 0;
+        int fd = -1;
+        size_t file_pos = 0, file_len = 0; // in records
+
+        const DataType &front() const { return data[cur]; }
+        // Write the run into a temporary file, return false if it fails
+        bool Spill(const std::string &file_name, const size_t id,
+                   const std::vector<DataType> &buf) {
+            std::string tmp_name = file_name + ".run" + std::to_string(id);
+            fd = open(tmp_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+                return false;
+            unlink(tmp_name.c_str()); // removed once closed
+            const char *ptr = reinterpret_cast<const char *>(buf.data());
+            size_t len = buf.size() * kRecSize;
+            while (len) {
+                ssize_t ret = write(fd, ptr, len);
+                if (ret <= 0)
+                    return false;
+                ptr += ret, len -= ret;
+            }
+            file_len = buf.size();
+            return true;
+        }
+        // Make sure front() is valid, return false when the run is finished
+        bool Fill(const size_t buf_len) {
+            if (cur < data.size())
+                return true;
+            if (fd < 0 || file_pos == file_len)
+                return false;
+            size_t len = std::min(buf_len, file_len - file_pos);
+            data.resize(len);
+            // the records are output already, so this cannot fall back
+            if (!ReadAll(fd, data.data(), len * kRecSize, file_pos * kRecSize))
+                throw UnknownException(UNKNOWN, "Cannot read a sorted run");
+            file_pos += len, cur = 0;
+            return true;
+        }
+        void Close() {
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+    };
+
+  private:
+    std::string file_name;
+    size_t memory_budget;
+    int thread_cnt;
+};
+
+} // namespace file
+
+} // namespace bookstore
+
+#endif
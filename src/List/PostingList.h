@@ -0,0 +1,69 @@
+/**
+ * @file PostingList.h
+ * @author Conless Pan (conlesspan@outlook.com)
+ * @brief Operations on sorted lists of values fetched from the ull
+ * @version 0.2
+ * @date 2022-12-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BOOKSTORE_LIST_POSTING_H
+#define BOOKSTORE_LIST_POSTING_H
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace bookstore {
+
+namespace list {
+
+/**
+ * @brief Intersect two sorted lists
+ * @details Walk the shorter list and gallop through the longer one, so the
+ * time cost is O(m log(n / m)) instead of O(n + m).
+ * @return std::vector<T> (the sorted intersection)
+ */
+template <class T>
+std::vector<T> Intersect(const std::vector<T> &a, const std::vector<T> &b) {
+    if (a.size() > b.size())
+        return Intersect(b, a);
+    std::vector<T> ret;
+    size_t las = 0; // all values before las in b are too small
+    for (const T &x : a) {
+        size_t step = 1, hi = las;
+        while (hi < b.size() && b[hi] < x) { // gallop to find a upper bound
+            las = hi + 1;
+            hi += step;
+            step <<= 1;
+        }
+        hi = std::min(hi, b.size());
+        las = std::lower_bound(b.begin() + las, b.begin() + hi, x) - b.begin();
+        if (las == b.size())
+            break;
+        if (b[las] == x)
+            ret.push_back(x);
+    }
+    return ret;
+}
+
+/**
+ * @brief Unite two sorted lists
+ * @return std::vector<T> (the sorted union without duplicates)
+ */
+template <class T>
+std::vector<T> Unite(const std::vector<T> &a, const std::vector<T> &b) {
+    std::vector<T> ret;
+    ret.reserve(a.size() + b.size());
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::back_inserter(ret));
+    return ret;
+}
+
+} // namespace list
+
+} // namespace bookstore
+
+#endif
@@ -28,8 +28,8 @@ namespace list {
  * data.
  * @param file_name
  */
-template <size_t kMaxKeyLen>
-UnrolledLinkedList<kMaxKeyLen>::UnrolledLinkedList(
+template <class Key, class Value>
+UnrolledLinkedList<Key, Value>::UnrolledLinkedList(
     const std::string &_file_name)
     : file_name(_file_name) {
     std::filesystem::create_directory(
@@ -38,10 +38,8 @@ UnrolledLinkedList<kMaxKeyLen>::UnrolledLinkedList(
     std::string dat_file = "data/" + file_name + ".dat";
     std::ifstream InputLog(log_file);
     blocks.clear();                            // Initialize the block system
-    blocks.push_back(ListBlock<kMaxKeyLen>()); // Insert a head block
-    for (int i = 1; i <= kMaxBlockCnt; i++)
-        free_blocks.insert(i); // Initialize the free_blocks set
-    if (InputLog.good()) {     // Found the history log
+    blocks.push_back(ListBlock<Key, Value>()); // Insert a head block
+    if (InputLog.good()) {                     // Found the history log
         file.open(dat_file);
         int T;
         InputLog >> T;
@@ -49,18 +47,23 @@ UnrolledLinkedList<kMaxKeyLen>::UnrolledLinkedList(
             size_t _len;
             int _pos;
             InputLog >> _len >> _pos;
-            blocks.push_back(ListBlock<kMaxKeyLen>(_len, _pos));
+            blocks.push_back(ListBlock<Key, Value>(_len, _pos));
             allocate(blocks[i]);
             blocks[i].head = blocks[i].data[0];
             blocks[i].tail = blocks[i].data[blocks[i].len - 1];
             deallocate(blocks[i]);
-            free_blocks.erase(_pos);
+            block_cnt = std::max(block_cnt, _pos);
         }
+        InputLog >> distinct_cnt; // the statistics of keys
     } else { // Create a new data file
         std::ofstream tmp(dat_file, std::ios::out);
         tmp.close();
         file.open(dat_file);
     }
+    for (int i = 1; i <= block_cnt; i++)
+        free_blocks.insert(i); // Initialize the free_blocks set
+    for (int i = 1; i < blocks.size(); i++)
+        free_blocks.erase(blocks[i].pos);
 }
 
 /**
@@ -68,8 +71,8 @@ UnrolledLinkedList<kMaxKeyLen>::UnrolledLinkedList(
  * @details The destructor of ull, which write the log file into the file system
  * for next use.
  */
-template <size_t kMaxKeyLen>
-UnrolledLinkedList<kMaxKeyLen>::~UnrolledLinkedList() {
+template <class Key, class Value>
+UnrolledLinkedList<Key, Value>::~UnrolledLinkedList() {
     std::string log_file = "data/" + file_name + ".log";
     std::ofstream OutputLog(
         log_file,
@@ -78,6 +81,7 @@ UnrolledLinkedList<kMaxKeyLen>::~UnrolledLinkedList() {
     OutputLog << len << '\n';
     for (int i = 1; i <= len; i++)
         OutputLog << blocks[i].len << ' ' << blocks[i].pos << '\n';
+    OutputLog << distinct_cnt << '\n';
     OutputLog.close();
 }
 
@@ -86,8 +90,8 @@ UnrolledLinkedList<kMaxKeyLen>::~UnrolledLinkedList() {
  * @return true when empty
  * @return false when not empty
  */
-template <size_t kMaxKeyLen>
-bool UnrolledLinkedList<kMaxKeyLen>::empty() const {
+template <class Key, class Value>
+bool UnrolledLinkedList<Key, Value>::empty() const {
     return blocks.size() == 0;
 }
 
@@ -97,26 +101,29 @@ bool UnrolledLinkedList<kMaxKeyLen>::empty() const {
  * @param key
  * @param value
  */
-template <size_t kMaxKeyLen>
-void UnrolledLinkedList<kMaxKeyLen>::insert(const KeyType<kMaxKeyLen> &key,
-                                            const int value) {
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::insert(const Key &key,
+                                            const Value &value) {
     DataType tmp(key, value);
     int len = blocks.size() - 1;
     if (!len) { // Insert the first data
-        blocks.push_back(ListBlock<kMaxKeyLen>(0, 1));
-        free_blocks.erase(1);
+        blocks.push_back(ListBlock<Key, Value>(0, new_block()));
         insert(blocks[1], tmp);
+        distinct_cnt++;
     } else {
-        int pos = 0;
+        int pos = len; // Insert the data into the last block by default
         for (int i = 1; i <= len; i++) {
             if (tmp <= blocks[i].tail) { // Find the block to insert into
-                insert(blocks[i], tmp);
                 pos = i;
                 break;
             }
         }
-        if (!pos) // Insert the data into the last block
-            insert(blocks[pos = len], tmp);
+        // The same data may be the tail of the previous block
+        if (pos > 1 && is_same(blocks[pos - 1].tail, tmp))
+            throw NormalException(ULL_INSERTED);
+        bool fresh = insert(blocks[pos], tmp);
+        if (fresh && !near_border(pos, key)) // a new key
+            distinct_cnt++;
         if (blocks[pos].len >= kMaxBlockSize) // Larger than the maximum size
             blocks.insert(blocks.begin() + pos + 1, split(blocks[pos]));
     }
@@ -128,23 +135,27 @@ void UnrolledLinkedList<kMaxKeyLen>::insert(const KeyType<kMaxKeyLen> &key,
  * @param key
  * @param value
  */
-template <size_t kMaxKeyLen>
-int UnrolledLinkedList<kMaxKeyLen>::erase(const KeyType<kMaxKeyLen> &key,
-                                          const int value) {
+template <class Key, class Value>
+Value UnrolledLinkedList<Key, Value>::erase(const Key &key,
+                                            const Value &value) {
     DataType tmp(key, value);
-    int len = blocks.size() - 1, val;
+    int len = blocks.size() - 1;
+    Value val;
     if (!len)
         throw NormalException(ULL_ERASE_NOT_FOUND);
     int pos = 0;
+    bool alone;
     for (int i = 1; i <= len; i++) {
         if (tmp <= blocks[i].tail) { // Found the block to erase from
-            val = erase(blocks[i], tmp);
+            val = erase(blocks[i], tmp, alone);
             pos = i;
             break;
         }
     }
     if (!pos) // Not found given data
         throw NormalException(ULL_ERASE_NOT_FOUND);
+    if (alone && !near_border(pos, key)) // the last data of the key
+        distinct_cnt--;
     if (!blocks[pos].len) { // The block becomes empty
         free_blocks.insert(blocks[pos].pos);
         blocks.erase(blocks.begin() + pos);
@@ -158,22 +169,22 @@ int UnrolledLinkedList<kMaxKeyLen>::erase(const KeyType<kMaxKeyLen> &key,
  * @brief Find the key in ull
  * @details Find all the values corresponding to the given key.
  * @param key
- * @return std::vector<int> (the corresponding values)
+ * @return std::vector<Value> (the corresponding values)
  */
-template <size_t kMaxKeyLen>
-std::vector<int>
-UnrolledLinkedList<kMaxKeyLen>::find(const KeyType<kMaxKeyLen> &key) {
+template <class Key, class Value>
+std::vector<Value>
+UnrolledLinkedList<Key, Value>::find(const Key &key) {
     int len = blocks.size() - 1;
     if (!len) // return an empty vector
-        return std::vector<int>();
-    std::vector<int> ret;
+        return std::vector<Value>();
+    std::vector<Value> ret;
     ret.clear();
     for (int i = 1; i <= len; i++) {
         if (blocks[i].head.key >
             key) // the minimum key of the current block is already too large
             break;
         else if (blocks[i].tail.key >= key) {
-            std::vector<int> ret_tmp = find(blocks[i], key);
+            std::vector<Value> ret_tmp = find(blocks[i], key);
             ret.insert(ret.end(), ret_tmp.begin(),
                        ret_tmp.end()); // connect the return vector to the end
         }
@@ -181,43 +192,390 @@ UnrolledLinkedList<kMaxKeyLen>::find(const KeyType<kMaxKeyLen> &key) {
     return ret;
 }
 
+/**
+ * @brief Scan the ull from the given data
+ * @details Return at most limit data which are not less than from, in order.
+ * Only the blocks holding the result are read, so a long list can be walked
+ * in pieces with constant memory.
+ * @param from
+ * @param limit
+ * @return std::vector<DataType<Key, Value>> (the data in order)
+ */
+template <class Key, class Value>
+std::vector<DataType<Key, Value>>
+UnrolledLinkedList<Key, Value>::scan(const DataType<Key, Value> &from,
+                                     const size_t limit) {
+    int len = blocks.size() - 1;
+    std::vector<DataType<Key, Value>> ret;
+    for (int i = 1; i <= len && ret.size() < limit; i++) {
+        if (blocks[i].tail < from) // the whole block is before from
+            continue;
+        allocate(blocks[i]);
+        int pos = std::lower_bound(blocks[i].data,
+                                   blocks[i].data + blocks[i].len, from) -
+                  blocks[i].data;
+        for (; pos < blocks[i].len && ret.size() < limit; pos++)
+            ret.push_back(blocks[i].data[pos]);
+        deallocate(blocks[i]);
+    }
+    return ret;
+}
+
+/**
+ * @brief Insert a batch of data into ull
+ * @details Sort the data and split it by the tails of the blocks, then each
+ * block receiving some data is read once, merged with them and written back
+ * as blocks of kBulkBlockSize. The data must not be in the ull yet.
+ * @param data
+ */
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::bulk_insert(
+    std::vector<DataType<Key, Value>> data) {
+    if (data.empty())
+        return;
+    std::sort(data.begin(), data.end());
+    auto key_less = [](const DataType<Key, Value> &x,
+                       const DataType<Key, Value> &y) { return x.key < y.key; };
+    int len = blocks.size() - 1;
+    std::vector<ListBlock<Key, Value>> res(1, blocks[0]);
+    if (!len) {
+        for (size_t i = 0; i < data.size(); i++)
+            distinct_cnt += !i || data[i].key != data[i - 1].key;
+        write_blocks(data, res);
+        blocks.swap(res);
+        return;
+    }
+    size_t beg = 0;
+    for (int i = 1; i <= len; i++) {
+        size_t end = i == len ? data.size()
+                              : std::upper_bound(data.begin() + beg, data.end(),
+                                                 blocks[i].tail) -
+                                    data.begin();
+        if (beg == end) {
+            res.push_back(blocks[i]);
+            continue;
+        }
+        allocate(blocks[i]);
+        DataType<Key, Value> *old_beg = blocks[i].data,
+                             *old_end = blocks[i].data + blocks[i].len;
+        for (size_t j = beg; j < end; j++) // count the keys new to the ull
+            if ((j == beg || data[j].key != data[j - 1].key) &&
+                !std::binary_search(old_beg, old_end, data[j], key_less) &&
+                !near_border(i, data[j].key))
+                distinct_cnt++;
+        std::vector<DataType<Key, Value>> merged(blocks[i].len + end - beg);
+        std::merge(old_beg, old_end, data.begin() + beg, data.begin() + end,
+                   merged.begin());
+        delete[] blocks[i].data; // rewritten below, so nothing is written
+        free_blocks.insert(blocks[i].pos);
+        write_blocks(merged, res);
+        beg = end;
+    }
+    blocks.swap(res);
+}
+
+/**
+ * @brief Erase a batch of data from ull
+ * @details Sort the data and split it by the tails of the blocks, then each
+ * block holding some data is read once and written back without them. All
+ * the data of a block must exist, or nothing is erased from it.
+ * @param data
+ */
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::bulk_erase(
+    std::vector<DataType<Key, Value>> data) {
+    std::sort(data.begin(), data.end());
+    size_t beg = 0;
+    int i = 1;
+    while (beg < data.size()) {
+        int len = blocks.size() - 1;
+        while (i <= len && blocks[i].tail < data[beg] &&
+               !is_same(blocks[i].tail, data[beg]))
+            i++;
+        if (i > len)
+            throw NormalException(ULL_ERASE_NOT_FOUND);
+        ListBlock<Key, Value> &cur = blocks[i];
+        allocate(cur);
+        std::vector<bool> erased(cur.len);
+        size_t end = beg;
+        for (int pos = 0; end < data.size(); end++) {
+            pos = std::lower_bound(cur.data + pos, cur.data + cur.len,
+                                   data[end]) -
+                  cur.data;
+            if (pos == cur.len)
+                break;
+            if (!is_same(cur.data[pos], data[end])) {
+                if (data[end] < cur.data[pos]) { // not in the ull
+                    deallocate(cur);
+                    throw NormalException(ULL_ERASE_NOT_FOUND);
+                }
+                break;
+            }
+            erased[pos++] = true;
+        }
+        int siz = 0;
+        for (int pos = 0; pos < cur.len; pos++)
+            if (!erased[pos])
+                cur.data[siz++] = cur.data[pos];
+        cur.len = siz;
+        if (siz) {
+            cur.head = cur.data[0];
+            cur.tail = cur.data[siz - 1];
+        }
+        for (size_t j = beg; j < end; j++) { // count the keys gone from the ull
+            if (j > beg && data[j].key == data[j - 1].key)
+                continue;
+            auto it = std::lower_bound(
+                cur.data, cur.data + siz, data[j],
+                [](const DataType<Key, Value> &x,
+                   const DataType<Key, Value> &y) { return x.key < y.key; });
+            if ((it == cur.data + siz || it->key != data[j].key) &&
+                !near_border(i, data[j].key))
+                distinct_cnt--;
+        }
+        deallocate(cur);
+        beg = end;
+        if (!siz) { // The block becomes empty
+            free_blocks.insert(cur.pos);
+            blocks.erase(blocks.begin() + i);
+        } else {
+            merge_try(i);
+            i = std::max(i - 1, 1);
+        }
+    }
+}
+
+/**
+ * @brief Write sorted data into new blocks
+ * @details The data is divided evenly into blocks no longer than
+ * kBulkBlockSize, or a single block if it fits.
+ * @param data
+ * @param res (the blocks written are appended to it)
+ */
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::write_blocks(
+    const std::vector<DataType<Key, Value>> &data,
+    std::vector<ListBlock<Key, Value>> &res) {
+    size_t cnt = data.size() < kMaxBlockSize
+                     ? 1
+                     : (data.size() + kBulkBlockSize - 1) / kBulkBlockSize;
+    for (size_t i = 0, beg = 0; i < cnt; i++) {
+        size_t end = data.size() * (i + 1) / cnt;
+        ListBlock<Key, Value> cur(end - beg, new_block());
+        cur.data = new DataType<Key, Value>[kMaxBlockSize];
+        std::copy(data.begin() + beg, data.begin() + end, cur.data);
+        cur.head = data[beg];
+        cur.tail = data[end - 1];
+        deallocate(cur);
+        res.push_back(cur);
+        beg = end;
+    }
+}
+
+/**
+ * @brief Find the first value of each key in a batch
+ * @details The keys are looked up in sorted order, so each block is read at
+ * most once.
+ * @param keys
+ * @return std::vector<Value> (the first value of each key, Value() if not
+ * found)
+ */
+template <class Key, class Value>
+std::vector<Value>
+UnrolledLinkedList<Key, Value>::bulk_find(const std::vector<Key> &keys) {
+    std::vector<Value> ret(keys.size());
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < keys.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&keys](size_t x, size_t y) { return keys[x] < keys[y]; });
+    int len = blocks.size() - 1, cur = 1, loaded = 0;
+    for (size_t id : order) {
+        const Key &key = keys[id];
+        while (cur <= len && blocks[cur].tail.key < key)
+            cur++;
+        if (cur > len)
+            break;
+        if (key < blocks[cur].head.key) // before the first block holding it
+            continue;
+        if (loaded != cur) {
+            if (loaded)
+                delete[] blocks[loaded].data; // only read, never changed
+            allocate(blocks[cur]);
+            loaded = cur;
+        }
+        DataType<Key, Value> *beg = blocks[cur].data,
+                             *end = blocks[cur].data + blocks[cur].len;
+        auto it = std::lower_bound(beg, end, key,
+                                   [](const DataType<Key, Value> &x,
+                                      const Key &y) { return x.key < y; });
+        if (it != end && it->key == key)
+            ret[id] = it->value;
+    }
+    if (loaded)
+        delete[] blocks[loaded].data;
+    return ret;
+}
+
 /**
  * @brief Get the size of the whole ull when testing
  * @details Count the size of each blocks and add them up.
  * @return size_t (the size of the ull)
  */
-template <size_t kMaxKeyLen> size_t UnrolledLinkedList<kMaxKeyLen>::size() {
+template <class Key, class Value> size_t UnrolledLinkedList<Key, Value>::size() {
     size_t ret = 0;
     for (const auto &cur : blocks)
         ret += cur.len;
     return ret;
 }
 
+/**
+ * @brief Get the number of distinct keys
+ * @return size_t
+ */
+template <class Key, class Value>
+size_t UnrolledLinkedList<Key, Value>::distinct() const {
+    return distinct_cnt;
+}
+
+/**
+ * @brief Estimate the number of data with the given key
+ * @details Only the cached heads and tails of blocks are used, so no block is
+ * read. The heavy keys filling whole blocks are counted by the length of those
+ * blocks, and a key inside some blocks is estimated by the average count of
+ * keys, bounded by the length of the blocks.
+ * @param key
+ * @return size_t (the estimated count, 0 if the key surely not exists)
+ */
+template <class Key, class Value>
+size_t UnrolledLinkedList<Key, Value>::estimate(const Key &key) {
+    int len = blocks.size() - 1;
+    size_t full = 0, border = 0;
+    for (int i = 1; i <= len; i++) {
+        if (blocks[i].head.key > key)
+            break;
+        if (blocks[i].tail.key < key)
+            continue;
+        if (blocks[i].head.key == key && blocks[i].tail.key == key)
+            full += blocks[i].len;
+        else
+            border += blocks[i].len;
+    }
+    if (full)
+        return full + border / 2;
+    if (!border)
+        return 0;
+    size_t avg = distinct_cnt ? size() / distinct_cnt : 1;
+    return std::max<size_t>(std::min(avg, border), 1);
+}
+
+/**
+ * @brief Judge whether the key is at the border of the neighbours of a block
+ * @details Only the cached head and tail are checked, so no block is read.
+ * @param pos
+ * @param key
+ */
+template <class Key, class Value>
+bool UnrolledLinkedList<Key, Value>::near_border(const int pos,
+                                                 const Key &key) {
+    int len = blocks.size() - 1;
+    if (pos > 1 && blocks[pos - 1].tail.key == key)
+        return true;
+    if (pos < len && blocks[pos + 1].head.key == key)
+        return true;
+    return false;
+}
+
+/**
+ * @brief Get the first value of the key, or insert the given one
+ * @details Only the first block whose tail is not less than the key is read,
+ * so a key is found or inserted within a single traversal.
+ * @param key
+ * @param value
+ * @return std::pair<Value, bool> (the value of the key, and whether it is
+ * inserted)
+ */
+template <class Key, class Value>
+std::pair<Value, bool>
+UnrolledLinkedList<Key, Value>::upsert(const Key &key, const Value &value) {
+    int len = blocks.size() - 1;
+    if (!len) {
+        insert(key, value);
+        return std::make_pair(value, true);
+    }
+    int pos = len; // Insert the data into the last block by default
+    for (int i = 1; i <= len; i++) {
+        if (key <= blocks[i].tail.key) { // Find the block holding the key
+            pos = i;
+            break;
+        }
+    }
+    ListBlock<Key, Value> &cur = blocks[pos];
+    allocate(cur);
+    int idx = std::lower_bound(cur.data, cur.data + cur.len, key,
+                               [](const DataType<Key, Value> &x,
+                                  const Key &y) { return x.key < y; }) -
+              cur.data;
+    if (idx < cur.len && cur.data[idx].key == key) { // the key exists
+        Value ret = cur.data[idx].value;
+        delete[] cur.data; // only read, never changed
+        return std::make_pair(ret, false);
+    }
+    DataType<Key, Value> tmp(key, value);
+    for (int i = cur.len; i > idx; i--) // move the data
+        cur.data[i] = cur.data[i - 1];
+    cur.data[idx] = tmp;
+    cur.len++;
+    cur.head = cur.data[0];
+    cur.tail = cur.data[cur.len - 1];
+    deallocate(cur);
+    distinct_cnt++;
+    if (cur.len >= kMaxBlockSize) // Larger than the maximum size
+        blocks.insert(blocks.begin() + pos + 1, split(cur));
+    return std::make_pair(value, true);
+}
+
 /**
  * @brief Output the data of a block when testing
  * @details Output all the data of a block. Only used when debugging.
  * @param cur
  */
-template <size_t kMaxKeyLen>
-void UnrolledLinkedList<kMaxKeyLen>::output(ListBlock<kMaxKeyLen> &cur) {
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::output(ListBlock<Key, Value> &cur) {
     allocate(cur);
     for (int i = 0; i < cur.len; i++)
-        std::cout << cur.data[i].key.str << " " << cur.data[i].value << '\n';
+        std::cout << cur.data[i].key << " " << cur.data[i].value << '\n';
     deallocate(cur);
 }
 
+/**
+ * @brief Take a free block slot
+ * @details The slot with the least position is taken, so that the file stays
+ * compact. When all the slots are used, a new one is added at the end of the
+ * file, so the number of blocks is not bounded.
+ * @return int (the position of the slot)
+ */
+template <class Key, class Value>
+int UnrolledLinkedList<Key, Value>::new_block() {
+    if (free_blocks.empty())
+        free_blocks.insert(++block_cnt);
+    int pos = *(free_blocks.begin());
+    free_blocks.erase(pos);
+    return pos;
+}
+
 /**
  * @brief Allocate a block
  * @details Register the space of a block and read it from the file system.
  * @param cur
  */
-template <size_t kMaxKeyLen>
-void UnrolledLinkedList<kMaxKeyLen>::allocate(ListBlock<kMaxKeyLen> &cur) {
-    cur.data = new DataType<kMaxKeyLen>[kMaxBlockSize]; // register the space
-    file.seekg(sizeof(DataType<kMaxKeyLen>) * kMaxBlockSize *
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::allocate(ListBlock<Key, Value> &cur) {
+    cur.data = new DataType<Key, Value>[kMaxBlockSize]; // register the space
+    file.seekg(sizeof(DataType<Key, Value>) * kMaxBlockSize *
                (cur.pos - 1)); // set the position to read at
     file.read(reinterpret_cast<char *>(cur.data),
-              sizeof(DataType<kMaxKeyLen>) * cur.len); // read the data
+              sizeof(DataType<Key, Value>) * cur.len); // read the data
 }
 
 /**
@@ -225,17 +583,17 @@ void UnrolledLinkedList<kMaxKeyLen>::allocate(ListBlock<kMaxKeyLen> &cur) {
  * @details Free the space of a block and write it to the file system.
  * @param cur
  */
-template <size_t kMaxKeyLen>
-void UnrolledLinkedList<kMaxKeyLen>::deallocate(ListBlock<kMaxKeyLen> &cur) {
-    file.seekp(sizeof(DataType<kMaxKeyLen>) * kMaxBlockSize *
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::deallocate(ListBlock<Key, Value> &cur) {
+    file.seekp(sizeof(DataType<Key, Value>) * kMaxBlockSize *
                (cur.pos - 1)); // set the position to write at
     file.write(reinterpret_cast<char *>(cur.data),
-               sizeof(DataType<kMaxKeyLen>) * cur.len); // write the data
+               sizeof(DataType<Key, Value>) * cur.len); // write the data
     delete[] cur.data;                                  // release the space
 }
-template <size_t kMaxKeyLen>
-bool UnrolledLinkedList<kMaxKeyLen>::is_same(const DataType<kMaxKeyLen> &data,
-                                             const DataType<kMaxKeyLen> &tmp) {
+template <class Key, class Value>
+bool UnrolledLinkedList<Key, Value>::is_same(const DataType<Key, Value> &data,
+                                             const DataType<Key, Value> &tmp) {
     return data.key == tmp.key && data.value == tmp.value;
 }
 
@@ -245,16 +603,17 @@ bool UnrolledLinkedList<kMaxKeyLen>::is_same(const DataType<kMaxKeyLen> &data,
  * search, with total time cost O(sqrt(n))
  * @param cur
  * @param tmp
+ * @return bool (whether the key is new to the block)
  */
-template <size_t kMaxKeyLen>
-void UnrolledLinkedList<kMaxKeyLen>::insert(ListBlock<kMaxKeyLen> &cur,
-                                            const DataType<kMaxKeyLen> &tmp) {
+template <class Key, class Value>
+bool UnrolledLinkedList<Key, Value>::insert(ListBlock<Key, Value> &cur,
+                                            const DataType<Key, Value> &tmp) {
     allocate(cur);  // allocate the current block
     if (!cur.len) { // first node of the block
         cur.data[0] = cur.head = cur.tail = tmp;
         cur.len++;
         deallocate(cur);
-        return;
+        return true;
     }
     int pos = std::lower_bound(cur.data, cur.data + cur.len, tmp) - cur.data;
     if (is_same(cur.data[pos], tmp) ||
@@ -263,6 +622,8 @@ void UnrolledLinkedList<kMaxKeyLen>::insert(ListBlock<kMaxKeyLen> &cur,
         deallocate(cur);
         throw NormalException(ULL_INSERTED);
     }
+    bool fresh = !((pos < cur.len && cur.data[pos].key == tmp.key) ||
+                   (pos && cur.data[pos - 1].key == tmp.key));
     if (!pos) // update the info of head and tail
         cur.head = tmp;
     if (pos == cur.len)
@@ -272,7 +633,7 @@ void UnrolledLinkedList<kMaxKeyLen>::insert(ListBlock<kMaxKeyLen> &cur,
     cur.len++;
     cur.data[pos] = tmp;
     deallocate(cur); // Deallocate the current block
-    return;
+    return fresh;
 }
 
 /**
@@ -281,18 +642,22 @@ void UnrolledLinkedList<kMaxKeyLen>::insert(ListBlock<kMaxKeyLen> &cur,
  * search, with total time cost O(sqrt(n))
  * @param cur
  * @param tmp
+ * @param alone (set to whether no other data of the key is in the block)
  * @return int (the pos of data)
  */
-template <size_t kMaxKeyLen>
-int UnrolledLinkedList<kMaxKeyLen>::erase(ListBlock<kMaxKeyLen> &cur,
-                                          const DataType<kMaxKeyLen> &tmp) {
+template <class Key, class Value>
+Value UnrolledLinkedList<Key, Value>::erase(ListBlock<Key, Value> &cur,
+                                            const DataType<Key, Value> &tmp,
+                                            bool &alone) {
     allocate(cur); // allocate the current block
     int pos = std::lower_bound(cur.data, cur.data + cur.len, tmp) - cur.data;
-    int value = cur.data[pos].value;
+    Value value = cur.data[pos].value;
     if (!is_same(cur.data[pos], tmp)) {
         deallocate(cur);
         throw NormalException(ULL_ERASE_NOT_FOUND);
     }
+    alone = !((pos + 1 < cur.len && cur.data[pos + 1].key == tmp.key) ||
+              (pos && cur.data[pos - 1].key == tmp.key));
     if (!pos && cur.len != 1) // update the info of head and tail
         cur.head = cur.data[pos + 1];
     if (pos == cur.len - 1 && cur.len != 1)
@@ -309,17 +674,17 @@ int UnrolledLinkedList<kMaxKeyLen>::erase(ListBlock<kMaxKeyLen> &cur,
  * @details Return all the corresponding values in current block in order
  * @param cur
  * @param key
- * @return std::vector<int> (the corresponding values)
+ * @return std::vector<Value> (the corresponding values)
  */
-template <size_t kMaxKeyLen>
-std::vector<int>
-UnrolledLinkedList<kMaxKeyLen>::find(ListBlock<kMaxKeyLen> &cur,
-                                     const KeyType<kMaxKeyLen> &key) {
+template <class Key, class Value>
+std::vector<Value>
+UnrolledLinkedList<Key, Value>::find(ListBlock<Key, Value> &cur,
+                                     const Key &key) {
     allocate(cur); // allocate the current block
-    std::vector<int> ret;
+    std::vector<Value> ret;
     ret.clear();
     int pos = std::lower_bound(cur.data, cur.data + cur.len,
-                               DataType<kMaxKeyLen>(key, 0)) -
+                               DataType<Key, Value>(key, Value())) -
               cur.data;
     for (; pos < cur.len; pos++) {
         if (cur.data[pos].key > key) // has finished the search
@@ -335,13 +700,13 @@ UnrolledLinkedList<kMaxKeyLen>::find(ListBlock<kMaxKeyLen> &cur,
  * @details When the size of a block is larger than expected, split into two
  * blocks by the middle.
  * @param cur
- * @return UnrolledLinkedList<kMaxKeyLen>::ListBlock (the info of the next
+ * @return UnrolledLinkedList<Key, Value>::ListBlock (the info of the next
  * block)
  */
-template <size_t kMaxKeyLen>
-ListBlock<kMaxKeyLen>
-UnrolledLinkedList<kMaxKeyLen>::split(ListBlock<kMaxKeyLen> &cur) {
-    ListBlock<kMaxKeyLen> nex(cur.len, cur.pos);
+template <class Key, class Value>
+ListBlock<Key, Value>
+UnrolledLinkedList<Key, Value>::split(ListBlock<Key, Value> &cur) {
+    ListBlock<Key, Value> nex(cur.len, cur.pos);
     allocate(cur); // allocate the current block
     allocate(nex); // allocate the next block
     nex.len >>= 1; // the length of the next block
@@ -352,14 +717,12 @@ UnrolledLinkedList<kMaxKeyLen>::split(ListBlock<kMaxKeyLen> &cur) {
     nex.head = nex.data[0];
     nex.tail = nex.data[nex.len - 1];
     deallocate(cur); // deallocate the current block
-    int nex_pos = *(free_blocks.begin());
-    free_blocks.erase(nex_pos);
-    nex.pos = nex_pos;
+    nex.pos = new_block();
     deallocate(nex); // deallocate the next block
     return nex;
 }
-template <size_t kMaxKeyLen>
-void UnrolledLinkedList<kMaxKeyLen>::merge_try(int pos) {
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::merge_try(int pos) {
     if (pos != 1 && blocks[pos].len + blocks[pos - 1].len <=
                         kMinBlockSize) { // Less than the minimum size, merge
                                          // with the previous
@@ -385,8 +748,8 @@ void UnrolledLinkedList<kMaxKeyLen>::merge_try(int pos) {
  * @param cur
  * @param del
  */
-template <size_t kMaxKeyLen>
-void UnrolledLinkedList<kMaxKeyLen>::merge(ListBlock<kMaxKeyLen> &cur, ListBlock<kMaxKeyLen> &del) {
+template <class Key, class Value>
+void UnrolledLinkedList<Key, Value>::merge(ListBlock<Key, Value> &cur, ListBlock<Key, Value> &del) {
     allocate(cur); // allocate the current block
     allocate(del); // allocate the block to be deleted
     for (int i = 0; i < del.len; i++)
@@ -397,23 +760,28 @@ void UnrolledLinkedList<kMaxKeyLen>::merge(ListBlock<kMaxKeyLen> &cur, ListBlock
     deallocate(del);             // deallocate the block to be deleted
     free_blocks.insert(del.pos); // free the block
 }
-template <size_t kMaxKeyLen>
-int UnrolledLinkedListUnique<kMaxKeyLen>::erase(const KeyType<kMaxKeyLen> &key) {
-    return UnrolledLinkedList<kMaxKeyLen>::erase(key, 0);
+template <class Key>
+int UnrolledLinkedListUnique<Key>::erase(const Key &key) {
+    return UnrolledLinkedList<Key>::erase(key, 0);
 }
-template <size_t kMaxKeyLen>
-int UnrolledLinkedListUnique<kMaxKeyLen>::find(const KeyType<kMaxKeyLen> &key) {
-    std::vector<int> ret = UnrolledLinkedList<kMaxKeyLen>::find(key);
+template <class Key>
+int UnrolledLinkedListUnique<Key>::find(const Key &key) {
+    std::vector<int> ret = UnrolledLinkedList<Key>::find(key);
     if (ret.empty())
         throw NormalException(ULL_NOT_FOUND);
     if (ret.size() >= 2)
         throw NormalException(ULL_DUPLICATED);
     return ret[0];
 }
-template <size_t kMaxKeyLen>
-bool UnrolledLinkedListUnique<kMaxKeyLen>::is_same(
-    const DataType<kMaxKeyLen> &data,
-    const DataType<kMaxKeyLen> &tmp) {
+template <class Key>
+std::pair<int, bool> UnrolledLinkedListUnique<Key>::upsert(const Key &key,
+                                                         const int value) {
+    return UnrolledLinkedList<Key>::upsert(key, value);
+}
+template <class Key>
+bool UnrolledLinkedListUnique<Key>::is_same(
+    const DataType<Key> &data,
+    const DataType<Key> &tmp) {
     return data.key == tmp.key;
 }
 
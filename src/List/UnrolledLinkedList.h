@@ -14,10 +14,14 @@
 
 #include <cstring>
 #include <fstream>
+#include <ostream>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "Utils/Money.h"
+
 namespace bookstore {
 
 namespace list {
@@ -56,21 +60,54 @@ template <size_t kMaxKeyLen> class KeyType {
     bool operator<=(const KeyType &x) const { return !(*this > x); }
     bool operator>=(const KeyType &x) const { return !(*this < x); }
     operator std::string() const { return std::string(str); }
+    friend std::ostream &operator<<(std::ostream &out, const KeyType &x) {
+        return out << x.str;
+    }
 
   public:
     char str[kMaxKeyLen];
 };
 
+/**
+ * @brief Class OrderedValue
+ * @details Package a value with the key it should be ordered by, so that the
+ * values under the same key of an ull are kept in the order of the given key
+ * (e.g. the positions of books kept in the order of their ISBN).
+ */
+template <class Order> class OrderedValue {
+  public:
+    Order order;
+    int value;
+    OrderedValue() : order(), value(0) {}
+    OrderedValue(const Order &_order, const int _value)
+        : order(_order), value(_value) {}
+    bool operator<(const OrderedValue &x) const {
+        return order == x.order ? value < x.value : order < x.order;
+    }
+    bool operator>(const OrderedValue &x) const {
+        return order == x.order ? value > x.value : order > x.order;
+    }
+    bool operator==(const OrderedValue &x) const {
+        return order == x.order && value == x.value;
+    }
+    bool operator!=(const OrderedValue &x) const { return !(*this == x); }
+    bool operator<=(const OrderedValue &x) const { return !(*this > x); }
+    bool operator>=(const OrderedValue &x) const { return !(*this < x); }
+    friend std::ostream &operator<<(std::ostream &out, const OrderedValue &x) {
+        return out << x.order << ' ' << x.value;
+    }
+};
+
 /**
  * @brief Class DataType
  * @details Package the pair of key and value, enable assignment and comparison.
  */
-template <size_t kMaxKeyLen> class DataType {
+template <class Key, class Value = int> class DataType {
   public:
-    KeyType<kMaxKeyLen> key;
-    int value;
-    DataType() : key(), value(0) {}
-    DataType(KeyType<kMaxKeyLen> _key, int _value) : key(_key), value(_value) {}
+    Key key;
+    Value value;
+    DataType() : key(), value() {}
+    DataType(Key _key, Value _value) : key(_key), value(_value) {}
     bool operator<(const DataType &x) const {
         return key == x.key ? value < x.value : key < x.key;
     }
@@ -90,15 +127,15 @@ template <size_t kMaxKeyLen> class DataType {
  * @details The type of a whole block, with fixed length kMaxBlockSize + 10.
  * Split when the length of a block is greater than kMaxBlockSize.
  */
-template <size_t kMaxKeyLen> class ListBlock {
+template <class Key, class Value = int> class ListBlock {
   public:
     ListBlock() : data(), len(0), pos(0) {}
     ListBlock(size_t _len, size_t _pos) : len(_len), pos(_pos) {}
     ~ListBlock() {}
 
   public:
-    DataType<kMaxKeyLen> *data;
-    DataType<kMaxKeyLen> head, tail;
+    DataType<Key, Value> *data;
+    DataType<Key, Value> head, tail;
     size_t len;
     size_t pos;
 };
@@ -109,8 +146,10 @@ template <size_t kMaxKeyLen> class ListBlock {
  supported
     - Insert, delete, find a data in O(sqrt(n))
     - Running with ram space O(sqrt(n)) and file space O(n)
+ * Key can be any trivially copyable type with a total order, e.g. KeyType or
+ an integer id.
  */
-template <size_t kMaxKeyLen> class UnrolledLinkedList {
+template <class Key, class Value = int> class UnrolledLinkedList {
   public:
     // The constructor of ull
     UnrolledLinkedList(const std::string &file_name);
@@ -123,62 +162,82 @@ template <size_t kMaxKeyLen> class UnrolledLinkedList {
     bool empty() const;
 
     // Operations
-    void insert(const char *key, const int value) {
-        insert(KeyType<kMaxKeyLen>(key), value);
-    }
-    void erase(const char *key, const int value) {
-        erase(KeyType<kMaxKeyLen>(key), value);
-    }
-    std::vector<int> find(const char *key) {
-        return find(KeyType<kMaxKeyLen>(key));
-    }
+    void insert(const Key &key, const Value &value);
+    Value erase(const Key &key, const Value &value);
+    std::vector<Value> find(const Key &key);
 
-    // Operations of custom string
-    void insert(const KeyType<kMaxKeyLen> &key, const int value);
-    int erase(const KeyType<kMaxKeyLen> &key, const int value);
-    std::vector<int> find(const KeyType<kMaxKeyLen> &key);
+    // Get at most limit data not less than the given one, in order
+    std::vector<DataType<Key, Value>> scan(const DataType<Key, Value> &from,
+                                           const size_t limit);
+
+    // Bulk operations, each block is read and written at most once
+    void bulk_insert(std::vector<DataType<Key, Value>> data);
+    void bulk_erase(std::vector<DataType<Key, Value>> data);
+    std::vector<Value> bulk_find(const std::vector<Key> &keys);
+
+    // Statistics of keys, kept in the log of the ull
+    size_t distinct() const;
+    size_t estimate(const Key &key);
 
   protected:
     // The type of block
     static const size_t kMinBlockSize = 128;
     static const size_t kMaxBlockSize = 256;
 
-    // The maximum number of blocks
-    static const size_t kMaxBlockCnt = 1000;
+    // The number of block slots reserved at first, the file grows by one slot
+    // whenever all of them are used
+    static const size_t kInitBlockCnt = 1000;
+
+    // The length of the blocks written by a bulk insertion
+    static const size_t kBulkBlockSize = (kMinBlockSize + kMaxBlockSize) / 2;
 
   protected:
     // Get the size of ull
     size_t size();
 
     // Output the data of a block
-    void output(ListBlock<kMaxKeyLen> &cur);
+    void output(ListBlock<Key, Value> &cur);
+
+    // Take a free block slot
+    int new_block();
 
     // Allocate a block
-    void allocate(ListBlock<kMaxKeyLen> &cur);
+    void allocate(ListBlock<Key, Value> &cur);
 
     // Deallocate a block
-    void deallocate(ListBlock<kMaxKeyLen> &cur);
+    void deallocate(ListBlock<Key, Value> &cur);
 
-    virtual bool is_same(const DataType<kMaxKeyLen> &data,
-                         const DataType<kMaxKeyLen> &tmp);
+    virtual bool is_same(const DataType<Key, Value> &data,
+                         const DataType<Key, Value> &tmp);
 
     // Insert a data to a block
-    void insert(ListBlock<kMaxKeyLen> &cur, const DataType<kMaxKeyLen> &tmp);
+    bool insert(ListBlock<Key, Value> &cur, const DataType<Key, Value> &tmp);
 
     // Erase a data from the block
-    int erase(ListBlock<kMaxKeyLen> &cur, const DataType<kMaxKeyLen> &tmp);
+    Value erase(ListBlock<Key, Value> &cur, const DataType<Key, Value> &tmp,
+                bool &alone);
 
     // Find some data in the block
-    std::vector<int> find(ListBlock<kMaxKeyLen> &cur,
-                          const KeyType<kMaxKeyLen> &key);
+    std::vector<Value> find(ListBlock<Key, Value> &cur,
+                          const Key &key);
 
     // Split a block
-    ListBlock<kMaxKeyLen> split(ListBlock<kMaxKeyLen> &cur);
+    ListBlock<Key, Value> split(ListBlock<Key, Value> &cur);
+
+    // Write sorted data into new blocks
+    void write_blocks(const std::vector<DataType<Key, Value>> &data,
+                      std::vector<ListBlock<Key, Value>> &res);
 
     void merge_try(int pos);
 
     // Merge two blocks
-    void merge(ListBlock<kMaxKeyLen> &cur, ListBlock<kMaxKeyLen> &del);
+    void merge(ListBlock<Key, Value> &cur, ListBlock<Key, Value> &del);
+
+    // Judge whether the key is at the border of the neighbour blocks
+    bool near_border(const int pos, const Key &key);
+
+    // Get the first value of the key, or insert the given one if not exists
+    std::pair<Value, bool> upsert(const Key &key, const Value &value);
 
   private:
     // Info of the file system
@@ -188,27 +247,37 @@ template <size_t kMaxKeyLen> class UnrolledLinkedList {
   private:
     // Info of the block system
     std::set<int> free_blocks;
-    std::vector<ListBlock<kMaxKeyLen>> blocks;
+    std::vector<ListBlock<Key, Value>> blocks;
+    int block_cnt = kInitBlockCnt; // the number of block slots in the file
+
+  private:
+    // Info of the statistics
+    size_t distinct_cnt = 0;
 };
 
-template <size_t kMaxKeyLen>
-class UnrolledLinkedListUnique : public UnrolledLinkedList<kMaxKeyLen> {
+template <class Key>
+class UnrolledLinkedListUnique : public UnrolledLinkedList<Key> {
   public:
     UnrolledLinkedListUnique(const std::string _file_name)
-        : UnrolledLinkedList<kMaxKeyLen>(_file_name) {}
-    int erase(const KeyType<kMaxKeyLen> &key);
-    int find(const KeyType<kMaxKeyLen> &key);
+        : UnrolledLinkedList<Key>(_file_name) {}
+    int erase(const Key &key);
+    int find(const Key &key);
+    std::pair<int, bool> upsert(const Key &key, const int value);
 
   protected:
-    bool is_same(const DataType<kMaxKeyLen> &data,
-                 const DataType<kMaxKeyLen> &tmp) override;
+    bool is_same(const DataType<Key> &data,
+                 const DataType<Key> &tmp) override;
 };
 
-template class UnrolledLinkedList<25>;
-template class UnrolledLinkedList<35>;
-template class UnrolledLinkedList<65>;
-template class UnrolledLinkedListUnique<25>;
-template class UnrolledLinkedListUnique<35>;
+template class UnrolledLinkedList<KeyType<25>>;
+template class UnrolledLinkedList<KeyType<35>>;
+template class UnrolledLinkedList<KeyType<65>>;
+template class UnrolledLinkedList<int>;
+template class UnrolledLinkedList<int, OrderedValue<KeyType<25>>>;
+template class UnrolledLinkedList<Money, OrderedValue<KeyType<25>>>;
+template class UnrolledLinkedListUnique<KeyType<25>>;
+template class UnrolledLinkedListUnique<KeyType<35>>;
+template class UnrolledLinkedListUnique<KeyType<65>>;
 
 } // namespace list
 
@@ -84,7 +84,12 @@ void LogSystem::WriteLog(const UserData &cur, const UserData &tmp,
         fout << cur << " delete the user ";
         fout << tmp << ".";
     } else if (msg.func == FINANCE) {
-        if (msg.args.size())
+        if (msg.args.size() && msg.args[0][0] == '-') {
+            fout << cur << " query the finance data with";
+            for (int i = 0; i < msg.args.size(); i += 2)
+                fout << ' ' << msg.args[i] << '=' << msg.args[i + 1];
+            fout << ".";
+        } else if (msg.args.size())
             fout << cur << " query the finance data of last " << msg.args[0] << " transanctions.";
         else fout << cur << " query all the finance data.";
     } else if (msg.func == SHOW_ALL) {
@@ -97,6 +102,28 @@ void LogSystem::WriteLog(const UserData &cur, const UserData &tmp,
         fout << cur << " query the books written by " << msg.args[0] << ".";
     } else if (msg.func == SHOW_KEYWORD) {
         fout << cur << " query the books with the keyword " << msg.args[0] << ".";
+    } else if (msg.func == SHOW_QUERY) {
+        fout << cur << " query the books with";
+        for (int i = 0; i < msg.args.size(); i += 2)
+            fout << ' ' << msg.args[i] << '=' << msg.args[i + 1];
+        fout << ".";
+    } else if (msg.func == SHOW_PRICE) {
+        fout << cur << " query the books priced from " << msg.args[0]
+             << " to " << msg.args[1] << ".";
+    } else if (msg.func == SHOW_STOCK) {
+        fout << cur << " query the books with fewer than " << msg.args[0]
+             << " in stock.";
+    } else if (msg.func == SHOW_BESTSELLERS) {
+        fout << cur << " query the " << msg.args[0] << " best selling books.";
+    } else if (msg.func == COMPLETE) {
+        fout << cur << " complete " << msg.args[0] << '=' << msg.args[1]
+             << ".";
+    } else if (msg.func == BUY && msg.args.size() > 2) {
+        fout << cur << " buy a cart of";
+        for (int i = 0; i < msg.args.size(); i += 2)
+            fout << (i ? ", " : " ") << msg.args[i + 1] << " x ISBN "
+                 << msg.args[i];
+        fout << ".";
     } else if (msg.func == BUY) {
         fout << cur << " buy " << msg.args[1] << " book";
         if (msg.args[0] != "1")
@@ -111,6 +138,21 @@ void LogSystem::WriteLog(const UserData &cur, const UserData &tmp,
         if (msg.args[0] != "1")
             fout << "s";
         fout << " which costs $" << msg.args[1] << ".";
+    } else if (msg.func == BULKLOAD) {
+        fout << cur << " bulk load " << tmp.second << " book";
+        if (tmp.second != 1)
+            fout << "s";
+        fout << " from " << msg.args[0] << ".";
+    } else if (msg.func == REPRICE) {
+        int end = msg.args.size() - 2;
+        fout << cur << " reprice " << tmp.second << " book";
+        if (tmp.second != 1)
+            fout << "s";
+        fout << " with";
+        for (int i = 0; i < end; i += 2)
+            fout << ' ' << msg.args[i] << '=' << msg.args[i + 1];
+        fout << (msg.args[end] == "-scale" ? " by x" : " to $")
+             << msg.args[end + 1] << ".";
     } else if (msg.func == LOG) {
         fout << cur << " query the log file.";
     }
@@ -14,7 +14,7 @@ const BookstoreUser UserGuest = {"Conmore", "Conmost",
                                  "Conleast", 0};
 
 UserFileSystem::UserFileSystem()
-    : BaseFileSystem("user"), uid_table("uid"), siz(0) {}
+    : BaseFileSystem("user"), siz(0), uid_table("uid") {}
 
 bool UserFileSystem::insert(const UserStr &uid, const BookstoreUser &data) {
     try {
@@ -36,6 +36,7 @@ bool UserFileSystem::erase(const UserStr &uid) {
     try {
         int pos = uid_table.erase(uid);
         BaseFileSystem::erase(pos);
+        uncache(uid);
         return 1;
     } catch (const NormalException &x) {
         if (x.what() == ULL_ERASE_NOT_FOUND)
@@ -51,6 +52,7 @@ bool UserFileSystem::edit(const UserStr &uid, const BookstoreUser &data) {
     try {
         int pos = uid_table.find(uid);
         BaseFileSystem::insert(pos, data);
+        uncache(uid);
         return 1;
     } catch (const NormalException &x) {
         if (x.what() == ULL_NOT_FOUND)
@@ -63,17 +65,53 @@ bool UserFileSystem::edit(const UserStr &uid, const BookstoreUser &data) {
 }
 
 BookstoreUser UserFileSystem::find(const UserStr &uid) {
+    int pos;
+    return find(uid, pos);
+}
+
+/**
+ * @brief Find the user record by its id
+ * @details The cached record is returned without reading the files, otherwise
+ * the record found is cached, dropping the least recently used one if full.
+ * @param uid
+ * @param pos (set to the position of the record, 0 if not exists)
+ * @return BookstoreUser (empty if not exists)
+ */
+BookstoreUser UserFileSystem::find(const UserStr &uid, int &pos) {
+    auto it = cache_table.find(uid.str);
+    if (it != cache_table.end()) {
+        cache.splice(cache.begin(), cache, it->second); // mark it as used
+        pos = it->second->second.pos;
+        return it->second->second.user;
+    }
     try {
-        int pos = uid_table.find(uid);
-        return BaseFileSystem::find(pos);
+        pos = uid_table.find(uid);
     } catch (const NormalException &x) {
-        if (x.what() == ULL_NOT_FOUND)
+        if (x.what() == ULL_NOT_FOUND) {
+            pos = 0;
             return BookstoreUser();
-        else {
+        } else {
             x.error();
             exit(-1);
         }
     }
+    BookstoreUser ret = BaseFileSystem::find(pos);
+    cache.emplace_front(uid.str, CachedUser{pos, ret});
+    cache_table[uid.str] = cache.begin();
+    if (cache.size() > kMaxCached) {
+        cache_table.erase(cache.back().first);
+        cache.pop_back();
+    }
+    return ret;
+}
+
+// Drop the cached record of uid
+void UserFileSystem::uncache(const UserStr &uid) {
+    auto it = cache_table.find(uid.str);
+    if (it == cache_table.end())
+        return;
+    cache.erase(it->second);
+    cache_table.erase(it);
 }
 
 void UserFileSystem::output() {
@@ -93,7 +131,8 @@ UserSystem::UserSystem() {
         user_table.insert(UserRoot.id, UserRoot);
         user_table.insert(UserGuest.id, UserGuest);
     }
-    user_stack.push_back(std::make_pair(UserGuest, 0));
+    user_table.find(UserRoot.id); // warm up the cache with root
+    user_table.find(UserGuest.id, guest_pos);
 }
 
 UserSystem::~UserSystem() {
@@ -101,6 +140,36 @@ UserSystem::~UserSystem() {
     fout << user_table.siz;
 }
 
+// Start a session with only the guest on its login stack
+void UserSystem::OpenSession(Session &session) {
+    while (!session.user_stack.empty())
+        PopLogin(session);
+    PushLogin(session, guest_pos, UserGuest);
+}
+
+// Logout all the accounts of a session
+void UserSystem::CloseSession(Session &session) {
+    while (!session.user_stack.empty())
+        PopLogin(session);
+}
+
+void UserSystem::PushLogin(Session &session, const int pos,
+                           const BookstoreUser &user) {
+    session.user_stack.push_back(Session::LoginEntry{pos, user.iden, 0});
+    auto it = login_table.find(pos);
+    if (it == login_table.end())
+        login_table.emplace(pos, LoginRecord{user.id, 1});
+    else
+        it->second.cnt++;
+}
+
+void UserSystem::PopLogin(Session &session) {
+    auto it = login_table.find(session.user_stack.back().pos);
+    if (!--it->second.cnt)
+        login_table.erase(it);
+    session.user_stack.pop_back();
+}
+
 void UserSystem::UserRegister(const char *user_id, const char *user_name,
                               const char *user_pswd) {
     BookstoreUser tmp(user_id, user_name, user_pswd, 1);
@@ -109,26 +178,27 @@ void UserSystem::UserRegister(const char *user_id, const char *user_name,
     return;
 }
 
-void UserSystem::UserLogin(const char *user_id, const char *user_pswd) {
-    BookstoreUser cur = user_stack.back().first;
-    BookstoreUser tmp = user_table.find(UserStr(user_id));
-    if (tmp.empty())
+void UserSystem::UserLogin(Session &session, const char *user_id,
+                           const char *user_pswd) {
+    const Session::LoginEntry &cur = session.user_stack.back();
+    int pos;
+    BookstoreUser tmp = user_table.find(UserStr(user_id), pos);
+    if (!pos)
         throw InvalidException("Not found such data");
     if ((cur.iden > tmp.iden && !strcmp(user_pswd, "")) ||
         user_pswd == tmp.pswd)
-        user_stack.push_back(std::make_pair(tmp, 0));
+        PushLogin(session, pos, tmp);
     else
         throw InvalidException("Wrong password!");
 }
-void UserSystem::UserLogout() {
-    BookstoreUser cur = user_stack.back().first;
-    if (cur == UserGuest)
+void UserSystem::UserLogout(Session &session) {
+    if (session.user_stack.back().iden == Guest)
         throw InvalidException("You've logout all the accounts");
-    user_stack.pop_back();
+    PopLogin(session);
 }
-int UserSystem::ModifyPassword(const char *user_id, const char *cur_pswd,
-                                const char *new_pswd) {
-    BookstoreUser cur = user_stack.back().first;
+int UserSystem::ModifyPassword(const Session &session, const char *user_id,
+                               const char *cur_pswd, const char *new_pswd) {
+    const Session::LoginEntry &cur = session.user_stack.back();
     BookstoreUser tmp = user_table.find(UserStr(user_id));
     if (tmp.empty())
         throw InvalidException("Not found such user when modifying the password.");
@@ -139,9 +209,10 @@ int UserSystem::ModifyPassword(const char *user_id, const char *cur_pswd,
         throw InvalidException("Wrong password when modifying the password.");
     return tmp.iden;
 }
-void UserSystem::UserAdd(const char *user_id, const char *user_name,
-                         const char *user_pswd, const int iden) {
-    BookstoreUser cur = user_stack.back().first;
+void UserSystem::UserAdd(const Session &session, const char *user_id,
+                         const char *user_name, const char *user_pswd,
+                         const int iden) {
+    const Session::LoginEntry &cur = session.user_stack.back();
     BookstoreUser tmp(user_id, user_name, user_pswd, iden);
     if (cur.iden <= iden)
         throw InvalidException(
@@ -149,13 +220,13 @@ void UserSystem::UserAdd(const char *user_id, const char *user_name,
     if (!user_table.insert(UserStr(user_id), tmp))
         throw InvalidException("The uid to be added already exists.");
 }
-int UserSystem::UserErase(const char *user_id) {
-    BookstoreUser cur = user_stack.back().first;
-    BookstoreUser tmp = user_table.find(UserStr(user_id));
-    for (auto dt : user_stack)
-        if (dt.first.id == user_id)
-            throw InvalidException("Deleting a login user");
-    if (tmp.empty())
+int UserSystem::UserErase(const Session &session, const char *user_id) {
+    const Session::LoginEntry &cur = session.user_stack.back();
+    int pos;
+    BookstoreUser tmp = user_table.find(UserStr(user_id), pos);
+    if (login_table.count(pos)) // logged in by any of the sessions
+        throw InvalidException("Deleting a login user");
+    if (!pos)
         throw InvalidException("Not found user when erasing");
     if (cur.iden <= tmp.iden)
         throw InvalidException(
@@ -164,20 +235,22 @@ int UserSystem::UserErase(const char *user_id) {
     return tmp.iden;
 }
 
-void UserSystem::SelectBook(const int book_pos) {
-    user_stack.back().second = book_pos;
+void UserSystem::SelectBook(Session &session, const int book_pos) {
+    session.user_stack.back().book = book_pos;
 }
 
-int UserSystem::GetIdentity() const { return user_stack.back().first.iden; }
+int UserSystem::GetIdentity(const Session &session) const {
+    return session.user_stack.back().iden;
+}
 
-int UserSystem::GetBook() const {
-    if (user_stack.back().first == UserGuest)
+int UserSystem::GetBook(const Session &session) const {
+    if (session.user_stack.back().iden == Guest)
         return 0;
-    return user_stack.back().second;
+    return session.user_stack.back().book;
 }
 
-std::string UserSystem::GetName() const {
-    return std::string(user_stack.back().first.id);
+const char *UserSystem::GetName(const Session &session) const {
+    return login_table.at(session.user_stack.back().pos).id.str;
 }
 
 void UserSystem::output() {
@@ -1,8 +1,11 @@
 #ifndef BOOKSTORE_USERSYSTEM_H
 #define BOOKSTORE_USERSYSTEM_H
 
+#include <list>
 #include <stack>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Files/FileSystem.h"
 #include "List/UnrolledLinkedList.h"
@@ -14,7 +17,7 @@ namespace user {
 const int kMaxUserLen = 35;
 
 using UserStr = list::KeyType<kMaxUserLen>;
-using map = list::UnrolledLinkedListUnique<kMaxUserLen>;
+using map = list::UnrolledLinkedListUnique<UserStr>;
 
 enum Identity {
     Manager = 7,
@@ -43,6 +46,12 @@ class BookstoreUser {
     Identity iden;
 };
 
+/**
+ * @brief Class UserFileSystem
+ * @details The user records are kept in a record file indexed by the uid
+ * table. The recently found records are also kept in a bounded LRU cache by
+ * their ids, so that the repeated logins do not touch the disk.
+ */
 class UserFileSystem : public file::BaseFileSystem<BookstoreUser> {
   public:
     UserFileSystem();
@@ -51,13 +60,55 @@ class UserFileSystem : public file::BaseFileSystem<BookstoreUser> {
     bool erase(const UserStr &uid);
     bool edit(const UserStr &uid, const BookstoreUser &data);
     BookstoreUser find(const UserStr &uid);
+    BookstoreUser find(const UserStr &uid, int &pos);
 
   public:
     void output();
     int siz;
 
+  private:
+    static const size_t kMaxCached = 64;
+
+    class CachedUser {
+      public:
+        int pos;
+        BookstoreUser user;
+    };
+    using Iterator = std::list<std::pair<std::string, CachedUser>>::iterator;
+
+    void uncache(const UserStr &uid);
+
   private:
     map uid_table;
+    // The cached records by their ids, the most recently used first
+    std::list<std::pair<std::string, CachedUser>> cache;
+    std::unordered_map<std::string, Iterator> cache_table;
+};
+
+/**
+ * @brief Class Session
+ * @details A terminal talking to the bookstore. It owns its login stack and the
+ * book selected by each account on it, while the users and the login counts
+ * are shared by all the sessions in the user system.
+ */
+class Session {
+  public:
+    Session() = default;
+    ~Session() = default;
+
+  private:
+    friend class UserSystem;
+
+    // An account on the login stack, the record itself stays in the file
+    class LoginEntry {
+      public:
+        int pos;       // the position of the user record
+        Identity iden;
+        int book;      // the selected book
+    };
+
+  private:
+    std::vector<LoginEntry> user_stack;
 };
 
 class UserSystem {
@@ -65,25 +116,42 @@ class UserSystem {
     UserSystem();
     ~UserSystem();
 
+    void OpenSession(Session &session);
+    void CloseSession(Session &session);
+
     void UserRegister(const char *user_id, const char *user_name,
                       const char *user_pswd);
-    void UserLogin(const char *user_id, const char *user_pswd);
-    void UserLogout();
-    int ModifyPassword(const char *user_id, const char *cur_pswd,
-                        const char *new_pswd);
-    void UserAdd(const char *user_id, const char *user_name,
-                 const char *user_pswd, const int user_iden);
-    int UserErase(const char *user_id);
-    void SelectBook(const int book_pos);
-    int GetBook() const;
-    int GetIdentity() const;
-    std::string GetName() const;
+    void UserLogin(Session &session, const char *user_id,
+                   const char *user_pswd);
+    void UserLogout(Session &session);
+    int ModifyPassword(const Session &session, const char *user_id,
+                       const char *cur_pswd, const char *new_pswd);
+    void UserAdd(const Session &session, const char *user_id,
+                 const char *user_name, const char *user_pswd,
+                 const int user_iden);
+    int UserErase(const Session &session, const char *user_id);
+    void SelectBook(Session &session, const int book_pos);
+    int GetBook(const Session &session) const;
+    int GetIdentity(const Session &session) const;
+    const char *GetName(const Session &session) const;
 
   protected:
     void output();
 
   private:
-    std::vector<std::pair<BookstoreUser, int>> user_stack;
+    // An account logged in at least once, indexed by its position
+    class LoginRecord {
+      public:
+        UserStr id;
+        int cnt; // the times it appears on the login stacks
+    };
+
+    void PushLogin(Session &session, const int pos, const BookstoreUser &user);
+    void PopLogin(Session &session);
+
+  private:
+    int guest_pos;
+    std::unordered_map<int, LoginRecord> login_table;
     UserFileSystem user_table;
 };
 
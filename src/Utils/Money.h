@@ -0,0 +1,114 @@
+#ifndef BOOKSTORE_MONEY_H
+#define BOOKSTORE_MONEY_H
+
+#include <climits>
+#include <cmath>
+#include <ostream>
+#include <string>
+
+#include "Utils/Exception.h"
+
+namespace bookstore {
+
+/**
+ * @brief Class Money
+ * @details An amount of money kept as an integer number of cents, so that the
+ * sums are exact. It is parsed from a validated token in a single pass and
+ * formatted with two decimals without the iostream number formatting.
+ */
+class Money {
+  public:
+    Money() : cents(0) {}
+    explicit Money(const long long _cents) : cents(_cents) {}
+
+    // Parse a validated decimal token, rounding to the nearest cent
+    static Money Parse(const std::string &str) {
+        long long ret = 0;
+        int digits = -1; // the number of digits after the dot
+        for (const char &ch : str) {
+            if (ch == '.') {
+                digits = 0;
+                continue;
+            }
+            if (digits >= 2) { // round by the third decimal only
+                if (digits == 2 && ch >= '5')
+                    ret++;
+                digits++;
+                continue;
+            }
+            ret = ret * 10 + (ch - '0');
+            if (digits >= 0)
+                digits++;
+        }
+        for (; digits < 2; digits = digits < 0 ? 1 : digits + 1)
+            ret *= 10;
+        return Money(ret);
+    }
+
+    long long value() const { return cents; }
+
+    // Multiply by a factor, rounding to the nearest cent
+    Money scale(const double factor) const {
+        double ret = cents * factor;
+        if (!(ret > LLONG_MIN && ret < LLONG_MAX)) // out of range or NaN
+            throw InvalidException("Money overflow");
+        return Money(std::llround(ret));
+    }
+
+    Money operator+(const Money &x) const { return Money(cents + x.cents); }
+    Money operator-(const Money &x) const { return Money(cents - x.cents); }
+    Money operator*(const long long x) const {
+        long long ret;
+        if (__builtin_mul_overflow(cents, x, &ret))
+            throw InvalidException("Money overflow");
+        return Money(ret);
+    }
+    Money &operator+=(const Money &x) {
+        cents += x.cents;
+        return *this;
+    }
+    Money &operator-=(const Money &x) {
+        cents -= x.cents;
+        return *this;
+    }
+
+    bool operator<(const Money &x) const { return cents < x.cents; }
+    bool operator>(const Money &x) const { return cents > x.cents; }
+    bool operator<=(const Money &x) const { return cents <= x.cents; }
+    bool operator>=(const Money &x) const { return cents >= x.cents; }
+    bool operator==(const Money &x) const { return cents == x.cents; }
+    bool operator!=(const Money &x) const { return cents != x.cents; }
+
+    // Write the amount with two decimals into buf, return the end of it
+    char *format(char *buf) const {
+        unsigned long long abs = cents < 0 ? -(unsigned long long)cents : cents;
+        char tmp[24];
+        int len = 0;
+        do {
+            tmp[len++] = '0' + abs % 10;
+            abs /= 10;
+            if (len == 2)
+                tmp[len++] = '.';
+        } while (abs || len <= 3);
+        if (cents < 0)
+            *buf++ = '-';
+        while (len)
+            *buf++ = tmp[--len];
+        return buf;
+    }
+    std::string str() const {
+        char buf[32];
+        return std::string(buf, format(buf));
+    }
+    friend std::ostream &operator<<(std::ostream &out, const Money &x) {
+        char buf[32];
+        return out.write(buf, x.format(buf) - buf);
+    }
+
+  private:
+    long long cents;
+};
+
+} // namespace bookstore
+
+#endif
@@ -1,6 +1,7 @@
 #include "TokenScanner.h"
 
 #include <cctype>
+#include <climits>
 #include <cstring>
 
 #include "Utils/Exception.h"
@@ -86,6 +87,34 @@ bool ValidateInt(const std::string &str) {
 bool ValidatePosInt(const std::string &str) {
     return ValidateInt(str) && str != "0";
 }
+// A validated int which fits into an int, so that it can be read by stoi
+bool ValidateIntRange(const std::string &str) {
+    return std::stoll(str) <= INT_MAX;
+}
+bool ValidateCursor(const std::string &str) {
+    if (!str.size() || str.size() % 2 || str.size() > 40)
+        return false;
+    for (const char &ch : str) {
+        if (!isxdigit(ch))
+            return false;
+    }
+    return true;
+}
+// A UTC time in the form YYYY-MM-DD or YYYY-MM-DDTHH
+bool ValidateTime(const std::string &str) {
+    if (str.size() != 10 && (str.size() != 13 || str[10] != 'T'))
+        return false;
+    if (str[4] != '-' || str[7] != '-')
+        return false;
+    for (int i = 0; i < str.size(); i++)
+        if (i != 4 && i != 7 && i != 10 && !isdigit(str[i]))
+            return false;
+    int year = std::stoi(str.substr(0, 4)), month = std::stoi(str.substr(5, 2)),
+        day = std::stoi(str.substr(8, 2));
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31)
+        return false;
+    return str.size() == 10 || std::stoi(str.substr(11, 2)) < 24;
+}
 bool ValidateDouble(const std::string &str) {
     if (str.size() > 13)
         return false;
@@ -201,7 +230,21 @@ BookstoreParser::BookstoreParser(const BookstoreLexer &input) {
         } else if (input[1] == "finance") {
             if (input.size() == 2)
                 ;
-            else if (input.size() == 3) {
+            else if (input[2][0] == '-') {
+                // A period of time is pushed as pairs of option and time
+                for (int i = 2; i < input.size(); i++) {
+                    BookstoreLexer input_div(input[i], '=');
+                    if (input_div.size() != 2 ||
+                        (input_div[0] != "-since" && input_div[0] != "-until") ||
+                        !ValidateTime(input_div[1]))
+                        throw InputException(input[0]);
+                    for (int j = 0; j < input_str.size(); j += 2)
+                        if (input_str[j] == input_div[0])
+                            throw InputException(input[0]);
+                    input_str.push_back(input_div[0]);
+                    input_str.push_back(input_div[1]);
+                }
+            } else if (input.size() == 3) {
                 if (!ValidateInt(input[2]))
                     throw InputException(input[0]);
                 input_str.push_back(input[2]);
@@ -209,43 +252,133 @@ BookstoreParser::BookstoreParser(const BookstoreLexer &input) {
                 throw InputException(input[0]);
             *this = BookstoreParser(FINANCE, input_str);
 
-        } else {
-            if (input.size() > 2)
+        } else if (input[1] == "price") {
+            if (input.size() != 4)
                 throw InputException(input[0]);
-            BookstoreLexer input_div(input[1], '=');
-            if (input_div.size() != 2)
+            if (!ValidateDouble(input[2]) || !ValidateDouble(input[3]))
                 throw InputException(input[0]);
-            if (!input_div[1].size())
+            input_str.push_back(input[2]);
+            input_str.push_back(input[3]);
+            *this = BookstoreParser(SHOW_PRICE, input_str);
+        } else if (input[1] == "stock") {
+            if (input.size() != 3)
                 throw InputException(input[0]);
-            if (input_div[0] == "-ISBN") {
-                if (!ValidateBookISBN(input_div[1]))
+            if (!ValidateInt(input[2]) || !ValidateIntRange(input[2]))
+                throw InputException(input[0]);
+            input_str.push_back(input[2]);
+            *this = BookstoreParser(SHOW_STOCK, input_str);
+        } else if (input[1] == "bestsellers") {
+            if (input.size() == 2)
+                input_str.push_back("10");
+            else if (input.size() == 3) {
+                if (!ValidatePosInt(input[2]) || !ValidateIntRange(input[2]))
                     throw InputException(input[0]);
-                input_str.push_back(input_div[1]);
-                *this = BookstoreParser(SHOW_ISBN, input_str);
-            } else {
-                if (!ValidateQuotation(input_div[1]) ||
-                    !ValidateBookInfo(input_div[1]))
+                input_str.push_back(input[2]);
+            } else
+                throw InputException(input[0]);
+            *this = BookstoreParser(SHOW_BESTSELLERS, input_str);
+        } else {
+            // Each condition is pushed as a pair of option and value, and the
+            // options of paging are pushed after all the conditions
+            BookstoreLexer page_str;
+            for (int i = 1; i < input.size(); i++) {
+                BookstoreLexer input_div(input[i], '=');
+                if (input_div.size() != 2)
+                    throw InputException(input[0]);
+                if (!input_div[1].size())
+                    throw InputException(input[0]);
+                if (input_div[0] == "-limit" || input_div[0] == "-offset" ||
+                    input_div[0] == "-cursor") {
+                    for (int j = 0; j < page_str.size(); j += 2)
+                        if (page_str[j] == input_div[0])
+                            throw InputException(input[0]);
+                    if (input_div[0] == "-cursor"
+                            ? !ValidateCursor(input_div[1])
+                            : !ValidateInt(input_div[1]) ||
+                                  !ValidateIntRange(input_div[1]))
+                        throw InputException(input[0]);
+                    page_str.push_back(input_div[0]);
+                    page_str.push_back(input_div[1]);
+                    continue;
+                }
+                if (input_div[0] == "-ISBN") {
+                    if (!ValidateBookISBN(input_div[1]))
+                        throw InputException(input[0]);
+                } else if (input_div[0] == "-name" ||
+                           input_div[0] == "-author" ||
+                           input_div[0] == "-keyword" ||
+                           input_div[0] == "-name*" ||
+                           input_div[0] == "-author*" ||
+                           input_div[0] == "-name~") {
+                    if (!ValidateQuotation(input_div[1]) ||
+                        !ValidateBookInfo(input_div[1]))
+                        throw InputException(input[0]);
+                } else
                     throw InputException(input[0]);
+                input_str.push_back(input_div[0]);
                 input_str.push_back(input_div[1]);
-                if (input_div[0] == "-name")
+            }
+            if (input_str.empty()) {
+                *this = BookstoreParser(SHOW_ALL, page_str);
+            } else if (input_str.size() == 2 && input_str[0].back() != '*' &&
+                       input_str[0].back() != '~' &&
+                       (input_str[0] != "-keyword" ||
+                        input_str[1].find('|') == std::string::npos)) {
+                std::string opt = input_str[0];
+                input_str.erase(input_str.begin());
+                input_str.insert(input_str.end(), page_str.begin(),
+                                 page_str.end());
+                if (opt == "-ISBN")
+                    *this = BookstoreParser(SHOW_ISBN, input_str);
+                else if (opt == "-name")
                     *this = BookstoreParser(SHOW_NAME, input_str);
-                else if (input_div[0] == "-author")
+                else if (opt == "-author")
                     *this = BookstoreParser(SHOW_AUTHOR, input_str);
-                else if (input_div[0] == "-keyword")
-                    *this = BookstoreParser(SHOW_KEYWORD, input_str);
                 else
-                    throw InputException(input[0]);
+                    *this = BookstoreParser(SHOW_KEYWORD, input_str);
+            } else {
+                input_str.insert(input_str.end(), page_str.begin(),
+                                 page_str.end());
+                *this = BookstoreParser(SHOW_QUERY, input_str);
             }
         }
         return;
     }
-    if (input[0] == "buy") {
-        if (input.size() != 3)
+    if (input[0] == "complete") {
+        if (input.size() != 2 && input.size() != 3)
             throw InputException(input[0]);
-        if (!ValidateBookISBN(input[1]) || !ValidatePosInt(input[2]))
+        BookstoreLexer input_div(input[1], '=');
+        if (input_div.size() != 2 || !input_div[1].size())
             throw InputException(input[0]);
-        input_str.push_back(input[1]);
-        input_str.push_back(input[2]);
+        if (input_div[0] == "-ISBN") {
+            if (!ValidateBookISBN(input_div[1]))
+                throw InputException(input[0]);
+        } else if (input_div[0] == "-name" || input_div[0] == "-author") {
+            if (!ValidateQuotation(input_div[1]) ||
+                !ValidateBookInfo(input_div[1]))
+                throw InputException(input[0]);
+        } else
+            throw InputException(input[0]);
+        if (input.size() == 3 &&
+            (!ValidatePosInt(input[2]) || !ValidateIntRange(input[2])))
+            throw InputException(input[0]);
+        input_str.push_back(input_div[0]);
+        input_str.push_back(input_div[1]);
+        input_str.push_back(input.size() == 3 ? input[2] : "10");
+        *this = BookstoreParser(COMPLETE, input_str);
+        return;
+    }
+    if (input[0] == "buy") {
+        // A cart of several books is pushed as pairs of ISBN and quantity
+        if (input.size() < 3 || input.size() % 2 == 0)
+            throw InputException(input[0]);
+        for (int i = 1; i < input.size(); i += 2) {
+            if (!ValidateBookISBN(input[i]) || !ValidatePosInt(input[i + 1]) ||
+                !ValidateIntRange(input[i + 1]))
+                throw InputException(input[0]);
+            input_str.push_back(input[i]);
+            input_str.push_back(input[i + 1]);
+        }
         *this = BookstoreParser(BUY, input_str);
         return;
     }
@@ -316,6 +449,42 @@ BookstoreParser::BookstoreParser(const BookstoreLexer &input) {
         *this = BookstoreParser(IMPORT, input_str);
         return;
     }
+    if (input[0] == "bulkload") {
+        if (input.size() != 2)
+            throw InputException(input[0]);
+        input_str.push_back(input[1]);
+        *this = BookstoreParser(BULKLOAD, input_str);
+        return;
+    }
+    if (input[0] == "reprice") {
+        // The conditions are pushed as pairs of option and value, followed by
+        // the pair of the new price or the scale
+        if (input.size() < 3)
+            throw InputException(input[0]);
+        for (int i = 1; i < input.size(); i++) {
+            BookstoreLexer input_div(input[i], '=');
+            if (input_div.size() != 2 || !input_div[1].size())
+                throw InputException(input[0]);
+            if (i == input.size() - 1) {
+                if ((input_div[0] != "-price" && input_div[0] != "-scale") ||
+                    !ValidateDouble(input_div[1]))
+                    throw InputException(input[0]);
+            } else if (input_div[0] == "-ISBN") {
+                if (!ValidateBookISBN(input_div[1]))
+                    throw InputException(input[0]);
+            } else if (input_div[0] == "-name" || input_div[0] == "-author" ||
+                       input_div[0] == "-keyword") {
+                if (!ValidateQuotation(input_div[1]) ||
+                    !ValidateBookInfo(input_div[1]))
+                    throw InputException(input[0]);
+            } else
+                throw InputException(input[0]);
+            input_str.push_back(input_div[0]);
+            input_str.push_back(input_div[1]);
+        }
+        *this = BookstoreParser(REPRICE, input_str);
+        return;
+    }
     if (input[0] == "log") {
         if (input.size() != 1)
             throw InputException(input[0]);
@@ -21,14 +21,26 @@ enum Function {
     SHOW_NAME,
     SHOW_AUTHOR,
     SHOW_KEYWORD,
+    SHOW_QUERY,
+    SHOW_PRICE,
+    SHOW_STOCK,
+    SHOW_BESTSELLERS,
+    COMPLETE,
     BUY,
     SEL,
     MODIFY,
     IMPORT,
+    BULKLOAD,
+    REPRICE,
     FINANCE,
     LOG
 };
 
+bool ValidateBookISBN(const std::string &str);
+bool ValidateBookInfo(const std::string &str);
+bool ValidateInt(const std::string &str);
+bool ValidateDouble(const std::string &str);
+
 class BookstoreLexer : public std::vector<std::string> {
   public:
     BookstoreLexer() {}
@@ -10,12 +10,14 @@ using namespace bookstore;
 int main(int argc, char *argv[]) {
     int output_status = JudgeInput(argc, argv);
     Bookstore root;
+    user::Session session;
+    root.OpenSession(session);
     std::string input;
     while (getline(std::cin, input)) {
         try {
             input::BookstoreLexer token(input);
             input::BookstoreParser msg(token);
-            root.AcceptMsg(msg);
+            root.AcceptMsg(session, msg);
             if (output_status)
                 std::cout << "Valid\n";
         } catch (const NormalException &msg) {
@@ -40,5 +42,6 @@ int main(int argc, char *argv[]) {
         if (output_status == 2)
             root.output();
     }
+    root.CloseSession(session);
     return 0;
 }
@@ -0,0 +1,19 @@
+#!/bin/sh
+# usage: run.sh [Bookstore_run] [case directory]
+# Run each [case].in in a fresh directory holding the TSV files of the cases,
+# and compare the output with [case].out
+bin=$1
+dir=$(cd "$2" && pwd)
+ret=0
+for input in "$dir"/*.in; do
+    name=$(basename "$input" .in)
+    tmp=$(mktemp -d)
+    cp "$dir"/*.tsv "$tmp"
+    (cd "$tmp" && "$bin" <"$input" >output)
+    if ! diff -u "$dir/$name.out" "$tmp/output"; then
+        echo "FAILED: $name"
+        ret=1
+    fi
+    rm -rf "$tmp"
+done
+exit $ret
@@ -0,0 +1,200 @@
+#include "List/UnrolledLinkedList.h"
+#include "Utils/Exception.h"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace bookstore::list;
+
+using Data = DataType<int>;
+using Model = set<Data>;
+
+void check(const bool cond, const char *msg) {
+    if (!cond) {
+        cerr << "FAILED: " << msg << '\n';
+        exit(1);
+    }
+}
+
+vector<Data> all(UnrolledLinkedList<int> &ull) {
+    return ull.scan(Data(INT_MIN, INT_MIN), SIZE_MAX);
+}
+
+size_t distinct(const Model &model) {
+    set<int> keys;
+    for (const Data &x : model)
+        keys.insert(x.key);
+    return keys.size();
+}
+
+void check_same(UnrolledLinkedList<int> &ull, const Model &model,
+                const char *msg) {
+    check(all(ull) == vector<Data>(model.begin(), model.end()), msg);
+    check(ull.distinct() == distinct(model), msg);
+}
+
+// Bulk insert into an empty ull and into existing blocks, then split them
+void test_bulk_insert() {
+    UnrolledLinkedList<int> ull("tst_bulk_insert");
+    Model model;
+    vector<Data> batch;
+    for (int i = 0; i < 1000; i++) // several blocks from nothing
+        batch.push_back(Data(i / 3 * 2, i));
+    ull.bulk_insert(batch);
+    model.insert(batch.begin(), batch.end());
+    check_same(ull, model, "bulk insert into an empty ull");
+
+    batch.clear();
+    for (int i = 0; i < 2000; i++) // merged into every block
+        batch.push_back(Data(i % 700, 5000 + i));
+    ull.bulk_insert(batch);
+    model.insert(batch.begin(), batch.end());
+    check_same(ull, model, "bulk insert into existing blocks");
+
+    for (int i = 0; i < 600; i++) { // split the blocks holding key 100
+        ull.insert(100, 10000 + i);
+        model.insert(Data(100, 10000 + i));
+    }
+    check_same(ull, model, "insert after bulk insert");
+    check(ull.find(100).size() == 600 + 3 + 3,
+          "find a key across split blocks");
+}
+
+// Scan from every data and between them, across the block boundaries
+void test_scan() {
+    UnrolledLinkedList<int> ull("tst_scan");
+    vector<Data> batch;
+    for (int i = 0; i < 3000; i++)
+        batch.push_back(Data(i / 2 * 2, i));
+    ull.bulk_insert(batch);
+    vector<Data> sorted(batch);
+    sort(sorted.begin(), sorted.end());
+    for (int from = -1; from < 3100; from += 7) {
+        for (size_t limit : {size_t(0), size_t(1), size_t(300), size_t(1000)}) {
+            auto beg = lower_bound(sorted.begin(), sorted.end(),
+                                   Data(from, INT_MIN));
+            auto end = sorted.end() - beg > limit ? beg + limit : sorted.end();
+            check(ull.scan(Data(from, INT_MIN), limit) ==
+                      vector<Data>(beg, end),
+                  "scan across the blocks");
+        }
+    }
+}
+
+// Find the first value of keys in and out of the ull
+void test_bulk_find() {
+    UnrolledLinkedList<int> ull("tst_bulk_find");
+    vector<Data> batch;
+    for (int i = 0; i < 2000; i++)
+        batch.push_back(Data(i / 4 * 3, i + 1));
+    ull.bulk_insert(batch);
+    vector<int> keys;
+    for (int key = 2000; key >= -5; key--) // unsorted, with the missing keys
+        keys.push_back(key);
+    keys.push_back(3); // repeated
+    vector<int> ret = ull.bulk_find(keys);
+    check(ret.size() == keys.size(), "bulk find size");
+    for (size_t i = 0; i < keys.size(); i++) {
+        int key = keys[i];
+        int expected = key >= 0 && key % 3 == 0 && key / 3 < 500
+                           ? key / 3 * 4 + 1
+                           : 0;
+        check(ret[i] == expected, "bulk find value");
+    }
+}
+
+// Bulk erase from many blocks, which then merge or become empty
+void test_bulk_erase() {
+    UnrolledLinkedList<int> ull("tst_bulk_erase");
+    Model model;
+    vector<Data> batch;
+    for (int i = 0; i < 3000; i++)
+        batch.push_back(Data(i / 5, i));
+    ull.bulk_insert(batch);
+    model.insert(batch.begin(), batch.end());
+
+    vector<Data> erased;
+    for (int i = 0; i < 3000; i++)
+        if (i % 3 == 0 || (i >= 1000 && i < 1800)) // empty a few blocks
+            erased.push_back(Data(i / 5, i));
+    ull.bulk_erase(erased);
+    for (const Data &x : erased)
+        model.erase(x);
+    check_same(ull, model, "bulk erase");
+
+    bool found = true;
+    try {
+        ull.bulk_erase(vector<Data>(1, Data(250, 1250)));
+    } catch (const NormalException &x) {
+        found = x.what() != ULL_ERASE_NOT_FOUND;
+    }
+    check(!found, "bulk erase a missing data");
+    check_same(ull, model, "a failed bulk erase changes nothing");
+
+    ull.bulk_erase(vector<Data>(model.begin(), model.end()));
+    model.clear();
+    check_same(ull, model, "bulk erase all");
+    ull.insert(1, 1); // the ull is usable again
+    model.insert(Data(1, 1));
+    check_same(ull, model, "insert after erasing all");
+}
+
+// Estimate the counts of heavy, light and missing keys
+void test_estimate() {
+    UnrolledLinkedList<int> ull("tst_estimate");
+    vector<Data> batch;
+    for (int i = 0; i < 1000; i++)
+        batch.push_back(Data(7, i));
+    for (int i = 0; i < 1000; i++)
+        batch.push_back(Data(100 + i, i));
+    ull.bulk_insert(batch);
+    check(ull.estimate(7) >= 500 && ull.estimate(7) <= 1500,
+          "estimate a heavy key");
+    check(ull.estimate(500) >= 1 && ull.estimate(500) <= 256,
+          "estimate a light key");
+    check(ull.estimate(1) == 0, "estimate a key before all");
+    check(ull.estimate(5000) == 0, "estimate a key after all");
+}
+
+// Hold more blocks than reserved at first, and keep them after reopening
+void test_capacity() {
+    const int kCnt = 300000; // about 1563 blocks of a bulk insertion
+    Model model;
+    {
+        UnrolledLinkedList<int> ull("tst_capacity");
+        vector<Data> batch;
+        for (int i = 0; i < kCnt; i++)
+            batch.push_back(Data(i % 100000, i));
+        ull.bulk_insert(batch);
+        model.insert(batch.begin(), batch.end());
+        check_same(ull, model, "bulk insert into many blocks");
+        check(ull.find(5) == vector<int>({5, 100005, 200005}),
+              "find in many blocks");
+    }
+    {
+        UnrolledLinkedList<int> ull("tst_capacity");
+        check_same(ull, model, "reopen many blocks");
+        for (int i = 0; i < 20000; i++) { // split and take more slots
+            ull.insert(99999, kCnt + i);
+            model.insert(Data(99999, kCnt + i));
+        }
+        vector<Data> batch;
+        for (int i = 0; i < 100000; i++)
+            batch.push_back(Data(i, -i - 1));
+        ull.bulk_insert(batch);
+        model.insert(batch.begin(), batch.end());
+        check_same(ull, model, "insert after reopening many blocks");
+    }
+}
+
+int main() {
+    filesystem::remove_all("data");
+    test_bulk_insert();
+    test_scan();
+    test_bulk_find();
+    test_bulk_erase();
+    test_estimate();
+    test_capacity();
+    cout << "ull bulk tests passed\n";
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "List/UnrolledLinkedList.h"
+#include "Utils/Exception.h"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace bookstore::list;
+
+using Str = KeyType<25>;
+
+void check(const bool cond, const char *msg) {
+    if (!cond) {
+        cerr << "FAILED: " << msg << '\n';
+        exit(1);
+    }
+}
+
+// The key of the i-th data, in the same order as i
+Str key(const int i) {
+    char str[25];
+    sprintf(str, "k%05d", i);
+    return Str(str);
+}
+
+// Insert the same key again when it is the tail of the previous block
+void test_unique_tail() {
+    UnrolledLinkedListUnique<Str> ull("tst_unique_tail");
+    for (int i = 0; i < 256; i++) // split into two blocks of 128
+        ull.insert(key(i), i);
+    bool inserted = true;
+    try {
+        ull.insert(key(127), 1000); // the tail of the first block
+    } catch (const NormalException &x) {
+        inserted = x.what() != ULL_INSERTED;
+    }
+    check(!inserted, "duplicated key at the tail of a block is inserted");
+    check(ull.find(key(127)) == 127, "the value of the key is changed");
+    check(ull.distinct() == 256, "the count of keys is changed");
+}
+
+// Insert the same data again when it is the tail of the previous block
+void test_multi_tail() {
+    UnrolledLinkedList<Str> ull("tst_multi_tail");
+    for (int i = 0; i < 256; i++)
+        ull.insert(key(i), i);
+    bool inserted = true;
+    try {
+        ull.insert(key(127), 127);
+    } catch (const NormalException &x) {
+        inserted = x.what() != ULL_INSERTED;
+    }
+    check(!inserted, "duplicated data at the tail of a block is inserted");
+    ull.insert(key(127), 1000); // another value of the key is fine
+    check(ull.find(key(127)) == vector<int>({127, 1000}),
+          "the values of the key are wrong");
+}
+
+// Upsert new keys in a shuffled order, then the existing ones
+void test_upsert() {
+    UnrolledLinkedListUnique<Str> ull("tst_upsert");
+    vector<int> order(2000);
+    for (int i = 0; i < order.size(); i++)
+        order[i] = i;
+    shuffle(order.begin(), order.end(), mt19937(2022));
+    for (int i : order) { // split many blocks
+        auto ret = ull.upsert(key(i), i);
+        check(ret.second && ret.first == i, "upsert a new key");
+    }
+    check(ull.distinct() == 2000, "the count of keys after upsert");
+    for (int i = 0; i < 2000; i += 7) {
+        auto ret = ull.upsert(key(i), -1);
+        check(!ret.second && ret.first == i, "upsert an existing key");
+        check(ull.find(key(i)) == i, "find after upsert");
+    }
+    for (int i = 0; i < 2000; i++) { // the tails of the blocks as well
+        auto ret = ull.upsert(key(i), -1);
+        check(!ret.second && ret.first == i, "upsert the tail of a block");
+    }
+    check(ull.distinct() == 2000, "the count of keys is changed by upsert");
+    bool inserted = true;
+    try {
+        ull.insert(key(1999), 0); // the last key is kept once
+    } catch (const NormalException &x) {
+        inserted = x.what() != ULL_INSERTED;
+    }
+    check(!inserted, "insert a key added by upsert");
+}
+
+int main() {
+    filesystem::remove_all("data");
+    test_unique_tail();
+    test_multi_tail();
+    test_upsert();
+    cout << "ull insert tests passed\n";
+    return 0;
+}